@@ -0,0 +1,45 @@
+/* Times the parser core on its own, without any of the Python overhead.
+ *
+ * Usage: make bench
+ *        ./benchmarking/bench_parser [TIMESTAMP [ITERATIONS]]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "parser.h"
+
+int
+main(int argc, char *argv[])
+{
+    const char *timestamp =
+        argc > 1 ? argv[1] : "2014-01-09T21:48:00.921000+05:30";
+    long iterations = argc > 2 ? atol(argv[2]) : 10000000;
+    size_t len = strlen(timestamp);
+    ciso8601_result result;
+    struct timespec start, stop;
+    double elapsed_ns;
+    long i;
+    /* Accumulated so that the compiler can't skip any of the calls */
+    long long checksum = 0;
+
+    if (ciso8601_parse(timestamp, len, 0, &result) != CISO8601_OK) {
+        fprintf(stderr, "Failed to parse '%s': %s (Index: %zu)\n", timestamp,
+                ciso8601_strerror(result.error), result.error_position);
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        ciso8601_parse(timestamp, len, 0, &result);
+        checksum += result.usecond;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    elapsed_ns = (stop.tv_sec - start.tv_sec) * 1e9 +
+                 (stop.tv_nsec - start.tv_nsec);
+    printf("%s: %.1f ns per parse (%ld iterations, checksum %lld)\n",
+           timestamp, elapsed_ns / iterations, iterations, checksum);
+    return 0;
+}
@@ -0,0 +1,245 @@
+import argparse
+import json
+import os
+import platform
+import random
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import timeit
+import tracemalloc
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Each family is a predicate on the timestamp string. A timestamp can belong to several families (ex. an ordinal date with an offset).
+DATE_PART = re.compile(r"^[0-9]{4}(?:-?W[0-9]{2}(?:-?[0-9])?|[0-9]{4}|-?[0-9]{3}|-[0-9]{2}(?:-[0-9]{2})?)")
+ORDINAL_DATE = re.compile(r"^[0-9]{4}-?[0-9]{3}$")
+OFFSET = re.compile(r"[+-][0-9]{2}(?::?[0-9]{2})?$")
+
+FAMILIES = {
+    "calendar_basic": lambda date, rest: "W" not in date and not ORDINAL_DATE.match(date) and "-" not in date,
+    "calendar_extended": lambda date, rest: "W" not in date and not ORDINAL_DATE.match(date) and "-" in date,
+    "ordinal": lambda date, rest: bool(ORDINAL_DATE.match(date)),
+    "week": lambda date, rest: "W" in date,
+    "date_only": lambda date, rest: rest == "",
+    "fraction": lambda date, rest: "." in rest or "," in rest,
+    "utc": lambda date, rest: rest[-1:] in ("Z", "z"),
+    "offset": lambda date, rest: bool(OFFSET.search(rest)),
+}
+
+
+def generate_corpora(size, seed):
+    # Appended, so that it doesn't shadow the ciso8601 build being benchmarked
+    sys.path.append(REPO_ROOT)
+    from generate_test_timestamps import generate_invalid_timestamp, generate_valid_timestamp_and_datetime
+
+    rng = random.Random(seed)
+    corpora = {family: [] for family in FAMILIES}
+    invalid = []
+    while min(len(members) for members in corpora.values()) < size:
+        params = {
+            "year": rng.randint(1, 9999),
+            "month": rng.randint(1, 12),
+            "day": rng.randint(1, 28),
+            "iso_week": rng.randint(1, 52),
+            "iso_day": rng.randint(1, 7),
+            "ordinal_day": rng.randint(1, 365),
+            "hour": rng.randint(0, 23),
+            "minute": rng.randint(0, 59),
+            "second": rng.randint(0, 59),
+            "microsecond": rng.randint(0, 999999),
+            "tzhour": rng.randint(0, 23),
+            "tzminute": rng.randint(0, 59),
+        }
+        for timestamp, _datetime in generate_valid_timestamp_and_datetime(**params):
+            date = DATE_PART.match(timestamp).group(0)
+            for family, predicate in FAMILIES.items():
+                if predicate(date, timestamp[len(date):]):
+                    corpora[family].append(timestamp)
+        if len(invalid) < size:
+            invalid.extend(timestamp for timestamp, _reason in generate_invalid_timestamp(**params))
+
+    for members in corpora.values():
+        rng.shuffle(members)
+        del members[size:]
+
+    # Fractions with more digits than a microsecond can hold (ex. nanosecond precision from other systems), which are truncated
+    corpora["long_fraction"] = [re.sub(r"([.,][0-9]+)", lambda m: m.group(1) + "987", timestamp) for timestamp in corpora["fraction"]]
+
+    rng.shuffle(invalid)
+    corpora["invalid"] = invalid[:size]
+
+    # A realistic mix of everything (including a few invalid timestamps), which is also used for the batch and memory measurements
+    mixed = [timestamp for family, members in corpora.items() if family != "invalid" for timestamp in members]
+    rng.shuffle(mixed)
+    corpora["mixed"] = mixed[:size - size // 100] + corpora["invalid"][:size // 100]
+    rng.shuffle(corpora["mixed"])
+    return corpora
+
+
+def parse_all(corpus):
+    # The per-timestamp loop used for every family, equivalent to what a typical caller does
+    import ciso8601
+
+    parse_datetime = ciso8601.parse_datetime
+    for timestamp in corpus:
+        try:
+            parse_datetime(timestamp)
+        except ValueError:
+            pass
+
+
+def time_corpus(stmt, corpus, repeat):
+    timer = timeit.Timer(lambda: stmt(corpus))
+    number, _time_taken = timer.autorange()
+    best = min(timer.repeat(repeat=repeat, number=number)) / number
+    total_bytes = sum(len(timestamp.encode("utf-8")) for timestamp in corpus)
+    return {
+        "count": len(corpus),
+        "ns_per_parse": best / len(corpus) * 1e9,
+        "bytes_per_sec": total_bytes / best,
+        "mean_length": total_bytes / len(corpus),
+    }
+
+
+def measure_peak_memory(corpus):
+    import ciso8601
+
+    valid = [timestamp for timestamp in corpus if _is_valid(timestamp)]
+    tracemalloc.start()
+    results = [ciso8601.parse_datetime(timestamp) for timestamp in valid]
+    _current, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+    memory = {
+        "tracemalloc_peak_bytes": peak,
+        "tracemalloc_peak_bytes_per_result": peak / max(len(results), 1),
+    }
+    try:
+        import resource
+
+        # KiB on Linux, bytes on macOS
+        max_rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        memory["max_rss_bytes"] = max_rss if sys.platform == "darwin" else max_rss * 1024
+    except ImportError:
+        pass
+    return memory
+
+
+def _is_valid(timestamp):
+    import ciso8601
+
+    try:
+        ciso8601.parse_datetime(timestamp)
+        return True
+    except ValueError:
+        return False
+
+
+def run(size, seed, repeat):
+    import ciso8601
+
+    corpora = generate_corpora(size, seed)
+    families = {family: time_corpus(parse_all, corpus, repeat) for family, corpus in corpora.items()}
+
+    # The valid part of the mixed corpus in a single call to a batch API (to epoch seconds)
+    mixed_valid = [timestamp for timestamp in corpora["mixed"] if _is_valid(timestamp)]
+    families["batch"] = time_corpus(lambda corpus: ciso8601.parse_bucket_many(corpus, 1), mixed_valid, repeat)
+
+    return {
+        "python": platform.python_implementation() + " " + platform.python_version(),
+        "platform": platform.platform(),
+        "ciso8601": ciso8601.__file__,
+        "caching_enabled": os.environ.get("CISO8601_CACHING_ENABLED"),
+        "pgo": os.environ.get("CISO8601_PGO"),
+        "size": size,
+        "seed": seed,
+        "families": families,
+        "memory": measure_peak_memory(corpora["mixed"]),
+    }
+
+
+def build_and_run(settings, args):
+    # Builds ciso8601 into a temporary directory with the given environment variables, and runs this script against it in a subprocess
+    build_dir = tempfile.mkdtemp(prefix="ciso8601_benchmark_")
+    try:
+        env = dict(os.environ, **settings)
+        subprocess.check_call(
+            [sys.executable, "setup.py", "-q", "build_ext", "--force", "--build-lib", build_dir, "--build-temp", os.path.join(build_dir, "temp")],
+            cwd=REPO_ROOT,
+            env=env,
+        )
+        env["PYTHONPATH"] = build_dir
+        output = subprocess.check_output(
+            [sys.executable, os.path.abspath(__file__), "--size", str(args.size), "--seed", str(args.seed), "--repeat", str(args.repeat)],
+            cwd=build_dir,
+            env=env,
+        )
+        return json.loads(output)
+    finally:
+        shutil.rmtree(build_dir, ignore_errors=True)
+
+
+# The build settings that can be compared, each as the environment variable that is set to "0" and then "1"
+COMPARISONS = {
+    "caching": "CISO8601_CACHING_ENABLED",
+    "pgo": "CISO8601_PGO",
+}
+
+
+def compare_builds(name, args):
+    results = {
+        name + "_disabled": build_and_run({COMPARISONS[name]: "0"}, args),
+        name + "_enabled": build_and_run({COMPARISONS[name]: "1"}, args),
+    }
+    # Relative change in ns/parse when the setting is enabled (negative is faster)
+    results[name + "_speedup"] = {
+        family: results[name + "_enabled"]["families"][family]["ns_per_parse"] / disabled["ns_per_parse"] - 1
+        for family, disabled in results[name + "_disabled"]["families"].items()
+    }
+    return results
+
+
+def print_summary(results, out):
+    compared = [name for name in COMPARISONS if name + "_speedup" in results]
+    if compared:
+        name = compared[0]
+        out.write("{0:<20}{1:>16}{2:>16}{3:>10}\n".format("family", "ns ({0}=0)".format(name), "ns ({0}=1)".format(name), "change"))
+        for family, change in results[name + "_speedup"].items():
+            out.write("{0:<20}{1:>16.1f}{2:>16.1f}{3:>+10.1%}\n".format(
+                family,
+                results[name + "_disabled"]["families"][family]["ns_per_parse"],
+                results[name + "_enabled"]["families"][family]["ns_per_parse"],
+                change,
+            ))
+    else:
+        out.write("{0:<20}{1:>12}{2:>16}\n".format("family", "ns/parse", "MB/s"))
+        for family, result in results["families"].items():
+            out.write("{0:<20}{1:>12.1f}{2:>16.1f}\n".format(family, result["ns_per_parse"], result["bytes_per_sec"] / 1e6))
+        out.write("peak memory: {0} bytes (tracemalloc)\n".format(results["memory"]["tracemalloc_peak_bytes"]))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmarks ciso8601 against corpora of every supported timestamp format (generated from the grammar in `generate_test_timestamps.py`).")
+    parser.add_argument("--size", type=int, default=1000, help="Number of timestamps in each family's corpus (default: 1000)")
+    parser.add_argument("--seed", type=int, default=8601, help="Random seed used to generate the corpora (default: 8601)")
+    parser.add_argument("--repeat", type=int, default=5, help="Number of timing repeats; the fastest is reported (default: 5)")
+    parser.add_argument("--compare-caching", action="store_true", help="Build ciso8601 with CISO8601_CACHING_ENABLED=0 and =1, and benchmark both")
+    parser.add_argument("--compare-pgo", action="store_true", help="Build ciso8601 with CISO8601_PGO=0 (the default build) and =1 (profile-guided optimization), and benchmark both")
+    parser.add_argument("--output", help="Where to write the JSON results (default: stdout, with no summary)")
+    args = parser.parse_args()
+
+    if args.compare_caching:
+        results = compare_builds("caching", args)
+    elif args.compare_pgo:
+        results = compare_builds("pgo", args)
+    else:
+        results = run(args.size, args.seed, args.repeat)
+
+    if args.output:
+        with open(args.output, "w") as fout:
+            json.dump(results, fout, indent=2, sort_keys=True)
+        print_summary(results, sys.stdout)
+    else:
+        json.dump(results, sys.stdout, indent=2, sort_keys=True)
@@ -0,0 +1,279 @@
+/* Counts the instructions, branches and branch misses that the parser core
+ * spends on each of a fixed set of inputs, which together cover each branch
+ * of parser.c (ISO 8601 timestamps, dates and times on their own, RFC 2822
+ * and HTTP dates, and durations) and isocalendar.c. Unlike wall-clock
+ * timings, these counts are (nearly) deterministic, so they can catch small
+ * regressions on noisy machines.
+ *
+ * The counts come from the hardware performance counters, via Linux's
+ * `perf_event_open`. Where those aren't available (ex. most CI runners and
+ * VMs), `instruction_counts.py` instead runs each input once under Callgrind.
+ *
+ * Usage: make benchmarking/count_instructions
+ *        ./benchmarking/count_instructions [--iterations N]
+ *        ./benchmarking/count_instructions --list
+ *        ./benchmarking/count_instructions --only NAME
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define RFC3339   CISO8601_FLAG_RFC3339
+#define NAIVE     CISO8601_FLAG_NAIVE
+#define PREFIX    CISO8601_FLAG_PREFIX
+#define HTTP_DATE CISO8601_FLAG_HTTP_DATE
+#define DATE_ONLY CISO8601_FLAG_DATE_ONLY
+#define TIME_ONLY CISO8601_FLAG_TIME_ONLY
+/* Not parser flags: which entry point other than `ciso8601_parse` an input is
+ * parsed with
+ */
+#define RFC2822  0x100
+#define DURATION 0x200
+
+static const struct {
+    const char *name;
+    int flags;
+    const char *timestamp;
+} inputs[] = {
+    /* Dates */
+    {"calendar_extended", 0, "2014-02-03"},
+    {"calendar_basic", 0, "20140203"},
+    {"year_month", 0, "2014-02"},
+    {"ordinal_extended", 0, "2014-034"},
+    {"ordinal_basic", 0, "2014034"},
+    {"ordinal_leap", 0, "2012-366"},
+    {"week_extended", 0, "2014-W06-1"},
+    {"week_extended_no_day", 0, "2014-W06"},
+    {"week_basic", 0, "2014W061"},
+    {"week_53", 0, "2015-W53-7"},
+    /* Times */
+    {"hour", 0, "2014-02-03T01"},
+    {"minute", 0, "2014-02-03T01:23"},
+    {"second", 0, "2014-02-03T01:23:45"},
+    {"basic_time", 0, "20140203T012345"},
+    {"space_separator", 0, "2014-02-03 01:23:45"},
+    {"fraction", 0, "2014-02-03T01:23:45.123456"},
+    {"fraction_comma", 0, "2014-02-03T01:23:45,123"},
+    {"fraction_long", 0, "2014-02-03T01:23:45.123456789"},
+    {"midnight_24", 0, "2014-02-03T24:00:00"},
+    /* Time zones */
+    {"utc", 0, "2014-02-03T01:23:45Z"},
+    {"offset_hour", 0, "2014-02-03T01:23:45+04"},
+    {"offset_extended", 0, "2014-02-03T01:23:45-04:30"},
+    {"offset_basic", 0, "20140203T012345+0430"},
+    {"naive", NAIVE, "2014-02-03T01:23:45.123456-04:30"},
+    {"rfc3339", RFC3339, "2014-02-03T01:23:45.123456+04:30"},
+    {"rfc3339_utc", RFC3339, "2014-02-03T01:23:45Z"},
+    /* Dates and times on their own */
+    {"date_only", DATE_ONLY, "2014-02-03"},
+    {"date_only_week", DATE_ONLY, "2014-W06-1"},
+    {"time_only", TIME_ONLY, "01:23:45.123456"},
+    {"time_only_offset", TIME_ONLY, "T012345+0430"},
+    /* RFC 2822 and HTTP dates */
+    {"rfc2822", RFC2822, "Tue, 01 Jul 2003 10:52:37 +0200"},
+    {"rfc2822_named_zone", RFC2822, "Tue, 01 Jul 03 10:52:37 EST"},
+    {"rfc2822_unknown_zone", RFC2822, "1 Jul 2003 10:52 A"},
+    {"http_imf_fixdate", RFC2822 | HTTP_DATE, "Sun, 06 Nov 1994 08:49:37 GMT"},
+    {"http_rfc850", RFC2822 | HTTP_DATE, "Sunday, 06-Nov-94 08:49:37 GMT"},
+    {"http_asctime", RFC2822 | HTTP_DATE, "Sun Nov  6 08:49:37 1994"},
+    /* Durations */
+    {"duration", DURATION, "P1Y2M3DT4H5M6S"},
+    {"duration_weeks", DURATION, "P2W"},
+    {"duration_fraction", DURATION, "-PT1.5S"},
+    /* Prefixes */
+    {"prefix_log_line", PREFIX, "2014-02-03T01:23:45.123Z INFO started"},
+    {"prefix_date_only", PREFIX, "2014-02-03 is a Monday"},
+    /* Errors */
+    {"error_end", 0, "2014-02-0"},
+    {"error_character", 0, "2014-02-0a"},
+    {"error_trailing", 0, "2014-02-03T01:23:45Zjunk"},
+    {"error_iso_week", 0, "2014-W54"},
+    {"error_ordinal", 0, "2014-366"},
+    {"error_mixed_formats", 0, "2014-02-03T012345"},
+    {"error_tzminute", 0, "2014-02-03T01:23:45+04:60"},
+    {"error_rfc3339", RFC3339, "2014-02-03"},
+    {"error_validate_day", 0, "2014-02-30"},
+    {"error_date_only", DATE_ONLY, "2014-02-03T01:23"},
+    {"error_time_only", TIME_ONLY, "2014-02-03T01:23"},
+    {"error_rfc2822_zone", RFC2822, "Tue, 01 Jul 2003 10:52:37 ABCDEF"},
+    {"error_http_zone", RFC2822 | HTTP_DATE, "Sun, 06 Nov 1994 08:49:37 UTC"},
+    {"error_duration_order", DURATION, "PT1S2M"},
+};
+
+#define INPUT_COUNT (sizeof(inputs) / sizeof(inputs[0]))
+
+typedef struct {
+    uint64_t instructions, branches, branch_misses;
+} Counts;
+
+/* What is measured for each input: a full parse, as done by the Python
+ * functions that don't build a datetime. It is only ever called through a
+ * volatile pointer, so that the compiler can't inline or specialize it (and so
+ * that Callgrind can find it by name).
+ */
+int
+count_instructions_parse(const char *str, size_t len, int flags,
+                         int64_t *epoch)
+{
+    ciso8601_result result;
+    ciso8601_duration duration;
+    ciso8601_error error;
+
+    if (flags & DURATION) {
+        if (ciso8601_parse_duration(str, len, &duration) != CISO8601_OK)
+            return -1;
+        *epoch = duration.values[CISO8601_DURATION_SECONDS];
+        return 0;
+    }
+
+    if (flags & RFC2822)
+        error = ciso8601_parse_rfc2822(str, len, flags & ~RFC2822, &result);
+    else
+        error = ciso8601_parse(str, len, flags, &result);
+    if (error != CISO8601_OK)
+        return -1;
+
+    /* A time on its own has no date to validate (as in `parse_time`) */
+    if (flags & TIME_ONLY) {
+        *epoch = result.hour * 3600 + result.minute * 60 + result.second;
+        return 0;
+    }
+    if (ciso8601_validate(&result) != CISO8601_OK)
+        return -1;
+    *epoch = ciso8601_epoch_seconds(&result);
+    return 0;
+}
+
+static int (*volatile parse)(const char *, size_t, int,
+                             int64_t *) = count_instructions_parse;
+
+#ifdef __linux__
+static int
+open_counter(int group, uint64_t config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+static int
+measure(int group, size_t index, long iterations, Counts *counts)
+{
+    const char *timestamp = inputs[index].timestamp;
+    size_t len = strlen(timestamp);
+    uint64_t values[4];
+    int64_t epoch;
+    long i;
+
+    /* Warm up the caches and branch predictors */
+    for (i = 0; i < 1000; i++)
+        parse(timestamp, len, inputs[index].flags, &epoch);
+
+    ioctl(group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    for (i = 0; i < iterations; i++)
+        parse(timestamp, len, inputs[index].flags, &epoch);
+    ioctl(group, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    if (read(group, values, sizeof(values)) < (ssize_t)sizeof(values))
+        return -1;
+    /* values[0] is the number of counters in the group */
+    counts->instructions = values[1];
+    counts->branches = values[2];
+    counts->branch_misses = values[3];
+    return 0;
+}
+#endif
+
+int
+main(int argc, char *argv[])
+{
+    long iterations = 100000;
+    const char *only = NULL;
+    int64_t epoch;
+    size_t index;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        }
+        else if (strcmp(argv[i], "--list") == 0) {
+            for (index = 0; index < INPUT_COUNT; index++)
+                printf("%s\n", inputs[index].name);
+            return 0;
+        }
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (only != NULL) {
+        /* A single parse of one input, for running under Callgrind */
+        for (index = 0; index < INPUT_COUNT; index++) {
+            if (strcmp(inputs[index].name, only) == 0) {
+                parse(inputs[index].timestamp,
+                      strlen(inputs[index].timestamp), inputs[index].flags,
+                      &epoch);
+                return 0;
+            }
+        }
+        fprintf(stderr, "Unknown input: %s\n", only);
+        return 2;
+    }
+
+#ifdef __linux__
+    {
+        Counts counts;
+        int group = open_counter(-1, PERF_COUNT_HW_INSTRUCTIONS);
+
+        if (group < 0 ||
+            open_counter(group, PERF_COUNT_HW_BRANCH_INSTRUCTIONS) < 0 ||
+            open_counter(group, PERF_COUNT_HW_BRANCH_MISSES) < 0) {
+            fprintf(stderr, "perf_event_open failed: %s\n", strerror(errno));
+            return 3;
+        }
+
+        /* One JSON object per line: name, then the counts per parse */
+        for (index = 0; index < INPUT_COUNT; index++) {
+            if (measure(group, index, iterations, &counts) < 0) {
+                fprintf(stderr, "Failed to read the counters\n");
+                return 3;
+            }
+            printf("{\"name\": \"%s\", \"instructions\": %.1f, "
+                   "\"branches\": %.1f, \"branch_misses\": %.3f}\n",
+                   inputs[index].name,
+                   (double)counts.instructions / iterations,
+                   (double)counts.branches / iterations,
+                   (double)counts.branch_misses / iterations);
+        }
+        return 0;
+    }
+#else
+    fprintf(stderr, "perf_event_open is only available on Linux\n");
+    return 3;
+#endif
+}
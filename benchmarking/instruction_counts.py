@@ -0,0 +1,141 @@
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BINARY = os.path.join("benchmarking", "count_instructions")
+BASELINE_DEFAULT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "instruction_counts_baseline.json")
+
+# Exit status of `count_instructions` when the hardware counters can't be opened
+COUNTERS_UNAVAILABLE = 3
+
+# Branch misses depend on the microarchitecture (or Callgrind's simulated predictor), so they are reported, but never fail the comparison.
+COMPARED_COUNTS = ("instructions", "branches")
+
+
+def build(cflags):
+    subprocess.check_call(["make", BINARY, "CFLAGS={0}".format(cflags)], cwd=REPO_ROOT)
+
+
+def count_with_perf(iterations):
+    process = subprocess.run([os.path.join(REPO_ROOT, BINARY), "--iterations", str(iterations)], stdout=subprocess.PIPE, universal_newlines=True)
+    if process.returncode == COUNTERS_UNAVAILABLE:
+        return None
+    process.check_returncode()
+    results = {}
+    for line in process.stdout.splitlines():
+        result = json.loads(line)
+        results[result.pop("name")] = result
+    return results
+
+
+def count_with_callgrind():
+    binary = os.path.join(REPO_ROOT, BINARY)
+    names = subprocess.check_output([binary, "--list"], universal_newlines=True).split()
+    output_dir = tempfile.mkdtemp(prefix="ciso8601_callgrind_")
+    results = {}
+    try:
+        for name in names:
+            output_file = os.path.join(output_dir, name + ".out")
+            subprocess.check_call(
+                [
+                    "valgrind", "--tool=callgrind", "--branch-sim=yes", "--toggle-collect=count_instructions_parse",
+                    "--callgrind-out-file={0}".format(output_file), binary, "--only", name,
+                ],
+                stdout=subprocess.DEVNULL,
+                stderr=subprocess.DEVNULL,
+            )
+            events = totals = None
+            with open(output_file) as fin:
+                for line in fin:
+                    if line.startswith("events:"):
+                        events = line.split()[1:]
+                    elif line.startswith("summary:") or line.startswith("totals:"):
+                        totals = [int(value) for value in line.split()[1:]]
+            counts = dict(zip(events, totals))
+            results[name] = {
+                "instructions": counts["Ir"],
+                "branches": counts["Bc"] + counts["Bi"],
+                "branch_misses": counts["Bcm"] + counts["Bim"],
+            }
+    finally:
+        shutil.rmtree(output_dir, ignore_errors=True)
+    return results
+
+
+def compare(results, baseline, tolerance, out):
+    # Returns the number of regressions (i.e., counts more than `tolerance` above the baseline)
+    regressions = 0
+    out.write("{0:<24}{1:>14}{2:>10}{3:>12}{4:>10}{5:>14}\n".format("input", "instructions", "change", "branches", "change", "branch misses"))
+    for name, counts in sorted(results.items()):
+        row = [name]
+        for count in COMPARED_COUNTS:
+            expected = baseline.get(name, {}).get(count)
+            change = (counts[count] / expected - 1) if expected else None
+            row.append(counts[count])
+            if change is None:
+                row.append("new")
+            else:
+                flag = ""
+                if change > tolerance:
+                    flag = " !"
+                    regressions += 1
+                elif change < -tolerance:
+                    flag = " *"
+                row.append("{0:+.1%}{1}".format(change, flag))
+        row.append(counts["branch_misses"])
+        out.write("{0:<24}{1:>14}{2:>10}{3:>12}{4:>10}{5:>14}\n".format(*row))
+    out.write("\n! = more than {0:.0%} above the baseline, * = more than {0:.0%} below it (consider updating the baseline)\n".format(tolerance))
+    return regressions
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Counts the instructions and branches per parse of the parser core for a fixed set of inputs, and compares them against a baseline.")
+    parser.add_argument("--baseline", default=BASELINE_DEFAULT, help="Baseline file (default: instruction_counts_baseline.json next to this script)")
+    parser.add_argument("--tolerance", type=float, default=0.02, help="Allowed relative increase over the baseline (default: 0.02, i.e., 2%%)")
+    parser.add_argument("--iterations", type=int, default=100000, help="Parses per input when using the hardware counters (default: 100000)")
+    parser.add_argument("--cflags", default="-O2 -g", help='CFLAGS to build with. The baseline is only meaningful for the same compiler and flags (default: "-O2 -g")')
+    parser.add_argument("--callgrind", action="store_true", help="Use Callgrind even if the hardware counters are available")
+    parser.add_argument("--update-baseline", action="store_true", help="Write the results into the baseline instead of comparing against it")
+    args = parser.parse_args()
+
+    build(args.cflags)
+
+    tool = "callgrind"
+    results = None if args.callgrind else count_with_perf(args.iterations)
+    if results is not None:
+        tool = "perf"
+    elif shutil.which("valgrind") is not None:
+        sys.stderr.write("Hardware counters unavailable, falling back to Callgrind\n")
+        results = count_with_callgrind()
+    else:
+        sys.exit("Neither the hardware counters (perf_event_open) nor Callgrind (valgrind) are available")
+
+    baselines = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as fin:
+            baselines = json.load(fin)
+
+    if args.update_baseline:
+        baselines[tool] = results
+        with open(args.baseline, "w") as fout:
+            json.dump(baselines, fout, indent=2, sort_keys=True)
+            fout.write("\n")
+        print("Updated the {0} baseline in {1}".format(tool, args.baseline))
+        sys.exit(0)
+
+    # The two tools count slightly differently (ex. perf includes the loop around each parse), so they each have their own baseline
+    baseline = baselines.get(tool, {})
+
+    print("Instruction counts per parse ({0})\n".format(tool))
+    regressions = compare(results, baseline, args.tolerance, sys.stdout)
+    # Without a baseline, nothing could have been found to regress
+    if not baseline:
+        sys.exit("There is no {0} baseline in {1} (run with --update-baseline to record one)".format(tool, args.baseline))
+    if regressions:
+        sys.exit("{0} count(s) regressed by more than {1:.0%}".format(regressions, args.tolerance))
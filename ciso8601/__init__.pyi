@@ -1,5 +1,153 @@
-from datetime import datetime
+from datetime import date, datetime, time, timedelta
+from typing import Any, Dict, Iterable, List, Literal, NamedTuple, Optional, Sequence, Tuple, Union, overload
 
-def parse_datetime(datetime_string: str) -> datetime: ...
+def parse_datetime(
+    datetime_string: str, *, assume_tz: Optional[str] = None, ambiguous: str = "earlier", nonexistent: str = "shift_forward"
+) -> datetime: ...
 def parse_rfc3339(datetime_string: str) -> datetime: ...
 def parse_datetime_as_naive(datetime_string: str) -> datetime: ...
+def parse_date(date_string: str) -> date: ...
+def parse_time(time_string: str) -> time: ...
+def parse_rfc2822(datetime_string: str) -> datetime: ...
+def parse_http_date(datetime_string: str) -> datetime: ...
+def parse_prefix(
+    datetime_string: Union[str, bytes, bytearray, memoryview],
+    pos: int = 0,
+    endpos: Optional[int] = None,
+) -> Tuple[datetime, int]: ...
+def parse_bucket(datetime_string: str, unit: Union[str, int], as_datetime: bool = False) -> Union[int, datetime]: ...
+@overload
+def parse_bucket_many(
+    datetime_strings: Iterable[str], unit: Union[str, int], as_datetime: bool = False, *, dedupe: Literal[False] = False
+) -> Union[List[int], List[datetime]]: ...
+@overload
+def parse_bucket_many(
+    datetime_strings: Iterable[str], unit: Union[str, int], as_datetime: bool = False, *, dedupe: Literal[True]
+) -> Union[Tuple[List[int], int], Tuple[List[datetime], int]]: ...
+@overload
+def parse_bucket_many(
+    datetime_strings: Iterable[str],
+    unit: Union[str, int],
+    as_datetime: bool = False,
+    *,
+    out: Any,
+    offset: int = 0,
+    dedupe: Literal[False] = False,
+) -> Tuple[int, List[int]]: ...
+@overload
+def parse_bucket_many(
+    datetime_strings: Iterable[str],
+    unit: Union[str, int],
+    as_datetime: bool = False,
+    *,
+    out: Any,
+    offset: int = 0,
+    dedupe: Literal[True],
+) -> Tuple[int, List[int], int]: ...
+@overload
+def parse_epoch_many(
+    datetime_strings: Iterable[str],
+    out: Any,
+    offset: int = 0,
+    *,
+    assume_tz: Optional[str] = None,
+    ambiguous: str = "earlier",
+    nonexistent: str = "shift_forward",
+    dedupe: Literal[False] = False,
+) -> Tuple[int, List[int]]: ...
+@overload
+def parse_epoch_many(
+    datetime_strings: Iterable[str],
+    out: Any,
+    offset: int = 0,
+    *,
+    assume_tz: Optional[str] = None,
+    ambiguous: str = "earlier",
+    nonexistent: str = "shift_forward",
+    dedupe: Literal[True],
+) -> Tuple[int, List[int], int]: ...
+@overload
+def parse_delimited_column(
+    buffer: Union[bytes, bytearray, memoryview],
+    column: int = 3,
+    delimiter: bytes = b",",
+    quotechar: Optional[bytes] = b'"',
+    *,
+    dedupe: Literal[False] = False,
+    skip_rows: int = 0,
+) -> List[datetime]: ...
+@overload
+def parse_delimited_column(
+    buffer: Union[bytes, bytearray, memoryview],
+    column: int = 3,
+    delimiter: bytes = b",",
+    quotechar: Optional[bytes] = b'"',
+    *,
+    dedupe: Literal[True],
+    skip_rows: int = 0,
+) -> Tuple[List[datetime], int]: ...
+@overload
+def parse_delimited_column(
+    buffer: Union[bytes, bytearray, memoryview],
+    column: int = 3,
+    delimiter: bytes = b",",
+    quotechar: Optional[bytes] = b'"',
+    *,
+    out: Any,
+    offset: int = 0,
+    dedupe: Literal[False] = False,
+    skip_rows: int = 0,
+) -> Tuple[int, List[int]]: ...
+@overload
+def parse_delimited_column(
+    buffer: Union[bytes, bytearray, memoryview],
+    column: int = 3,
+    delimiter: bytes = b",",
+    quotechar: Optional[bytes] = b'"',
+    *,
+    out: Any,
+    offset: int = 0,
+    dedupe: Literal[True],
+    skip_rows: int = 0,
+) -> Tuple[int, List[int], int]: ...
+
+class Timestamp:
+    @property
+    def epoch_microseconds(self) -> int: ...
+    @property
+    def utcoffset_minutes(self) -> Optional[int]: ...
+    def to_datetime(self) -> datetime: ...
+    def timestamp(self) -> float: ...
+    def __sub__(self, other: Timestamp) -> timedelta: ...
+    def __lt__(self, other: Timestamp) -> bool: ...
+    def __le__(self, other: Timestamp) -> bool: ...
+    def __gt__(self, other: Timestamp) -> bool: ...
+    def __ge__(self, other: Timestamp) -> bool: ...
+    def __hash__(self) -> int: ...
+
+def parse_timestamp_obj(datetime_string: str) -> Timestamp: ...
+def argsort_timestamps(datetime_strings: Iterable[str]) -> List[int]: ...
+def bisect_timestamps(
+    sorted_seq: Sequence[str],
+    instant: Union[str, datetime, Timestamp],
+    lo: int = 0,
+    hi: Optional[int] = None,
+    *,
+    side: str = "left",
+) -> int: ...
+
+class TimestampStats(NamedTuple):
+    count: int
+    errors: int
+    min: Optional[Timestamp]
+    max: Optional[Timestamp]
+    monotonic: bool
+    histogram: Optional[Dict[int, int]]
+
+def timestamp_stats(
+    timestamps: Union[Iterable[str], bytes, bytearray, memoryview], bucket: Optional[Union[str, int]] = None
+) -> TimestampStats: ...
+def parse_duration(duration_string: str, approximate: bool = False) -> timedelta: ...
+def parse_interval(interval_string: str) -> Tuple[datetime, datetime]: ...
+def stats() -> Optional[Dict[str, Any]]: ...
+def reset_stats() -> None: ...
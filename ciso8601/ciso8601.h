@@ -0,0 +1,106 @@
+/* C API for use by other extension modules.
+ *
+ * Usage (much like `datetime.h`):
+ *
+ *     #include "ciso8601.h"
+ *
+ *     // Once, in the module init function:
+ *     if (CISO8601_IMPORT < 0)
+ *         return NULL;
+ *
+ *     // Then, wherever needed:
+ *     PyObject *dt = CISO8601API->parse_datetime(buf, len, 0);
+ *
+ * All of the functions must be called with the GIL held. On failure they
+ * return NULL/-1 with a Python exception set, exactly like the equivalent
+ * Python functions would raise.
+ *
+ * New members are only ever appended to the end of `CISO8601_CAPI`, and each
+ * addition increments `CISO8601_CAPI_VERSION`.
+ */
+#ifndef CISO8601_H
+#define CISO8601_H
+
+#include <Python.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CISO8601_CAPI_VERSION 2
+#define CISO8601_CAPSULE_NAME "ciso8601._C_API"
+
+/* Flags */
+/* Only accept RFC 3339 timestamps (i.e., like `parse_rfc3339`) */
+#define CISO8601_RFC3339 0x1
+/* Ignore time zone information (i.e., like `parse_datetime_as_naive`) */
+#define CISO8601_NAIVE 0x2
+/* Parse RFC 2822 dates instead of ISO 8601 (i.e., like `parse_rfc2822`).
+ * Since version 2.
+ */
+#define CISO8601_RFC2822 0x4
+/* Parse RFC 7231 HTTP-dates instead of ISO 8601 (i.e., like
+ * `parse_http_date`). Since version 2.
+ */
+#define CISO8601_HTTP_DATE 0x8
+
+typedef struct {
+    int year, month, day, hour, minute, second, usecond;
+    /* 0 for naive timestamps, in which case `tzminute` is 0 */
+    int has_tzinfo;
+    /* Offset from UTC in minutes, in the range (-1440, 1440) exclusive */
+    int tzminute;
+} CISO8601_Fields;
+
+typedef struct {
+    /* The CISO8601_CAPI_VERSION that the module was built with */
+    int version;
+
+    /* Returns a new reference to a datetime */
+    PyObject *(*parse_datetime)(const char *str, size_t len, int flags);
+
+    /* Stores the number of microseconds since 1970-01-01T00:00:00Z in
+     * `epoch_us`. Naive timestamps are treated as though they were in UTC.
+     */
+    int (*parse_epoch)(const char *str, size_t len, int flags,
+                       int64_t *epoch_us);
+
+    /* Fills `fields` with the validated components of the timestamp. The
+     * special case of 24:00:00 is normalized to 00:00:00 of the following
+     * day.
+     */
+    int (*parse_fields)(const char *str, size_t len, int flags,
+                        CISO8601_Fields *fields);
+} CISO8601_CAPI;
+
+#ifndef CISO8601_MODULE
+
+static CISO8601_CAPI *CISO8601API = NULL;
+
+static int
+ciso8601_import_capi(void)
+{
+    CISO8601API =
+        (CISO8601_CAPI *)PyCapsule_Import(CISO8601_CAPSULE_NAME, 0);
+    if (CISO8601API == NULL)
+        return -1;
+
+    if (CISO8601API->version < CISO8601_CAPI_VERSION) {
+        PyErr_Format(PyExc_ImportError,
+                     "ciso8601 C API version %d is too old (need %d)",
+                     CISO8601API->version, CISO8601_CAPI_VERSION);
+        CISO8601API = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+#define CISO8601_IMPORT ciso8601_import_capi()
+
+#endif /* CISO8601_MODULE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
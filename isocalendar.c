@@ -54,7 +54,8 @@
 
 #include "isocalendar.h"
 
-#include "Python.h"
+#include <assert.h>
+#include <stdint.h>
 
 /* ---------------------------------------------------------------------------
  * General calendrical helper functions
@@ -89,7 +90,7 @@ is_leap(int year)
 }
 
 /* year, month -> number of days in that month in that year */
-static int
+int
 days_in_month(int year, int month)
 {
     assert(month >= 1);
@@ -100,131 +101,71 @@ days_in_month(int year, int month)
         return _days_in_month[month];
 }
 
-/* year, month -> number of days in year preceding first day of month */
-static int
-days_before_month(int year, int month)
-{
-    int days;
-
-    assert(month >= 1);
-    assert(month <= 12);
-    days = _days_before_month[month];
-    if (month > 2 && is_leap(year))
-        ++days;
-    return days;
-}
-
-/* year -> number of days before January 1st of year.  Remember that we
- * start with year 1, so days_before_year(1) == 0.
- */
-static int
-days_before_year(int year)
-{
-    int y = year - 1;
-    /* This is incorrect if year <= 0; we really want the floor
-     * here.  But so long as MINYEAR is 1, the smallest year this
-     * can see is 1.
-     */
-    assert(year >= 1);
-    return y * 365 + y / 4 - y / 100 + y / 400;
-}
-
-/* Number of days in 4, 100, and 400 year cycles.  That these have
- * the correct values is asserted in the module init function.
+/* The conversions between ordinals and (year, month, day) below are the
+ * Euclidean affine function algorithms of Neri and Schneider ("Euclidean
+ * affine functions and their application to calendar algorithms", 2022).
+ * Rather than CPython's chains of divisions and remainders by 400, 100 and 4
+ * year cycles, they only divide by constants (which compilers turn into
+ * multiplications and shifts) and have a single branch, for January and
+ * February.
+ *
+ * Both work in a "computational" calendar whose years start on March 1st, so
+ * that the leap day is the last day of the year. It is shifted back by one
+ * 400-year cycle so that the unsigned arithmetic also gives the right answers
+ * for year 0 (which `iso_to_ymd` can be asked about, and which the callers
+ * then reject as out of range). Day 0 of that calendar is 1st March of
+ * year -400, which is 146097 + 306 days before 01-Jan-0001 (i.e., ordinal 1).
  */
-#define DI4Y   1461   /* days_before_year(5); days in 4 years */
-#define DI100Y 36524  /* days_before_year(101); days in 100 years */
-#define DI400Y 146097 /* days_before_year(401); days in 400 years  */
+#define COMPUTATIONAL_YEAR_SHIFT       400
+#define COMPUTATIONAL_DAY_OF_ORDINAL_0 (146097 + 305)
 
 /* ordinal -> year, month, day, considering 01-Jan-0001 as day 1. */
-static void
+void
 ord_to_ymd(int ordinal, int *year, int *month, int *day)
 {
-    int n, n1, n4, n100, n400, leapyear, preceding;
-
-    /* ordinal is a 1-based index, starting at 1-Jan-1.  The pattern of
-     * leap years repeats exactly every 400 years.  The basic strategy is
-     * to find the closest 400-year boundary at or before ordinal, then
-     * work with the offset from that boundary to ordinal.  Life is much
-     * clearer if we subtract 1 from ordinal first -- then the values
-     * of ordinal at 400-year boundaries are exactly those divisible
-     * by DI400Y:
-     *
-     *    D  M   Y            n              n-1
-     *    -- --- ----        ----------     ----------------
-     *    31 Dec -400        -DI400Y       -DI400Y -1
-     *     1 Jan -399         -DI400Y +1   -DI400Y      400-year boundary
-     *    ...
-     *    30 Dec  000        -1             -2
-     *    31 Dec  000         0             -1
-     *     1 Jan  001         1              0          400-year boundary
-     *     2 Jan  001         2              1
-     *     3 Jan  001         3              2
-     *    ...
-     *    31 Dec  400         DI400Y        DI400Y -1
-     *     1 Jan  401         DI400Y +1     DI400Y      400-year boundary
-     */
-    assert(ordinal >= 1);
-    --ordinal;
-    n400 = ordinal / DI400Y;
-    n = ordinal % DI400Y;
-    *year = n400 * 400 + 1;
-
-    /* Now n is the (non-negative) offset, in days, from January 1 of
-     * year, to the desired date.  Now compute how many 100-year cycles
-     * precede n.
-     * Note that it's possible for n100 to equal 4!  In that case 4 full
-     * 100-year cycles precede the desired day, which implies the
-     * desired day is December 31 at the end of a 400-year cycle.
-     */
-    n100 = n / DI100Y;
-    n = n % DI100Y;
-
-    /* Now compute how many 4-year cycles precede it. */
-    n4 = n / DI4Y;
-    n = n % DI4Y;
-
-    /* And now how many single years.  Again n1 can be 4, and again
-     * meaning that the desired day is December 31 at the end of the
-     * 4-year cycle.
-     */
-    n1 = n / 365;
-    n = n % 365;
-
-    *year += n100 * 100 + n4 * 4 + n1;
-    if (n1 == 4 || n100 == 4) {
-        assert(n == 0);
-        *year -= 1;
-        *month = 12;
-        *day = 31;
-        return;
-    }
-
-    /* Now the year is correct, and n is the offset from January 1.  We
-     * find the month via an estimate that's either exact or one too
-     * large.
-     */
-    leapyear = n1 == 3 && (n4 != 24 || n100 == 3);
-    assert(leapyear == is_leap(*year));
-    *month = (n + 50) >> 5;
-    preceding = (_days_before_month[*month] + (*month > 2 && leapyear));
-    if (preceding > n) {
-        /* estimate is too large */
-        *month -= 1;
-        preceding -= days_in_month(*year, *month);
-    }
-    n -= preceding;
-    assert(0 <= n);
-    assert(n < days_in_month(*year, *month));
-
-    *day = n + 1;
+    uint32_t n, n_century, n_year, century_year, m, j;
+    uint64_t p;
+
+    assert(ordinal > -146097);
+    n = (uint32_t)(ordinal + COMPUTATIONAL_DAY_OF_ORDINAL_0);
+
+    /* Century, and the day of the century */
+    n = 4 * n + 3;
+    century_year = n / 146097 * 100;
+    n_century = n % 146097 / 4;
+
+    /* Year of the century, and the day of the year */
+    n = 4 * n_century + 3;
+    p = (uint64_t)2939745 * n;
+    century_year += (uint32_t)(p >> 32);
+    n_year = (uint32_t)p / 2939745 / 4;
+
+    /* Month (March is 3, ..., February is 14) and day of the month */
+    m = 2141 * n_year + 197913;
+    j = n_year >= 306; /* i.e., January or February of the next year */
+
+    *year = (int)(century_year + j) - COMPUTATIONAL_YEAR_SHIFT;
+    *month = (int)((m >> 16) - 12 * j);
+    *day = (int)((m & 0xFFFF) / 2141) + 1;
 }
 
 /* year, month, day -> ordinal, considering 01-Jan-0001 as day 1. */
-static int
+int
 ymd_to_ord(int year, int month, int day)
 {
-    return days_before_year(year) + days_before_month(year, month) + day;
+    const uint32_t j = month <= 2; /* January and February end the year */
+    const uint32_t y = (uint32_t)(year + COMPUTATIONAL_YEAR_SHIFT) - j;
+    const uint32_t m = (uint32_t)month + 12 * j;
+    const uint32_t century = y / 100;
+    uint32_t n;
+
+    assert(year > -COMPUTATIONAL_YEAR_SHIFT);
+    assert(month >= 1);
+    assert(month <= 12);
+    n = 1461 * y / 4 - century + century / 4; /* Days before the year */
+    n += (979 * m - 2919) / 32;               /* Days before the month */
+    n += (uint32_t)day - 1;
+    return (int)n - COMPUTATIONAL_DAY_OF_ORDINAL_0;
 }
 
 /* Day of week, where Monday==0, ..., Sunday==6.  1/1/1 was a Monday. */
@@ -9,4 +9,13 @@ int
 ordinal_to_ymd(const int iso_year, const int ordinal_day, int *year,
                int *month, int *day);
 
+void
+ord_to_ymd(int ordinal, int *year, int *month, int *day);
+
+int
+ymd_to_ord(int year, int month, int day);
+
+int
+days_in_month(int year, int month);
+
 #endif
@@ -2,8 +2,13 @@
 #include <ctype.h>
 #include <datetime.h>
 
+#define CISO8601_MODULE
+#include "ciso8601/ciso8601.h"
 #include "isocalendar.h"
+#include "parser.h"
+#include "stats.h"
 #include "timezone.h"
+#include "tzfile.h"
 
 #define STRINGIZE(x)            #x
 #define EXPAND_AND_STRINGIZE(x) STRINGIZE(x)
@@ -30,500 +35,2917 @@ static PyObject *utc;
 static PyObject *tz_cache[2879] = {NULL};
 #endif
 
-#define PARSE_INTEGER(field, length, field_name)                      \
-    for (i = 0; i < length; i++) {                                    \
-        if (*c >= '0' && *c <= '9') {                                 \
-            field = 10 * field + *c++ - '0';                          \
-        }                                                             \
-        else {                                                        \
-            return format_unexpected_character_exception(             \
-                field_name, c, (c - str) / sizeof(char), length - i); \
-        }                                                             \
-    }
-
-#define PARSE_FRACTIONAL_SECOND()                             \
-    for (i = 0; i < 6; i++) {                                 \
-        if (*c >= '0' && *c <= '9') {                         \
-            usecond = 10 * usecond + *c++ - '0';              \
-        }                                                     \
-        else if (i == 0) {                                    \
-            /* We need at least one digit. */                 \
-            /* Trailing '.' or ',' is not allowed */          \
-            return format_unexpected_character_exception(     \
-                "subsecond", c, (c - str) / sizeof(char), 1); \
-        }                                                     \
-        else                                                  \
-            break;                                            \
-    }                                                         \
-                                                              \
-    /* Omit excessive digits */                               \
-    while (*c >= '0' && *c <= '9') c++;                       \
-                                                              \
-    /* If we break early, fully expand the usecond */         \
-    while (i++ < 6) usecond *= 10;
-
-#define PARSE_SEPARATOR(separator, field_name)                                \
-    if (separator) {                                                          \
-        c++;                                                                  \
-    }                                                                         \
-    else {                                                                    \
-        PyObject *unicode_str = PyUnicode_FromString(c);                      \
-        PyObject *unicode_char = PyUnicode_Substring(unicode_str, 0, 1);      \
-        PyErr_Format(PyExc_ValueError,                                        \
-                     "Invalid character while parsing %s ('%U', Index: %lu)", \
-                     field_name, unicode_char, (c - str) / sizeof(char));     \
-        Py_DECREF(unicode_str);                                               \
-        Py_DECREF(unicode_char);                                              \
-        return NULL;                                                          \
-    }
-
-static void *
-format_unexpected_character_exception(char *field_name, const char *c,
-                                      size_t index,
-                                      int expected_character_count)
-{
-    if (*c == '\0') {
-        PyErr_Format(
-            PyExc_ValueError,
-            "Unexpected end of string while parsing %s. Expected %d more "
-            "character%s",
-            field_name, expected_character_count,
-            (expected_character_count != 1) ? "s" : "");
-    }
-    else if (*c == '-' && index == 0 && strcmp(field_name, "year") == 0) {
-        PyErr_Format(
-            PyExc_ValueError,
-            "Invalid character while parsing %s ('-', Index: 0). "
-            "While valid ISO 8601 years, BCE years are not supported by "
-            "Python's `datetime` objects.",
-            field_name);
+/* Returns the (possibly multi-byte) UTF-8 encoded character at `c` as a str.
+ * Invalid UTF-8 (which can only come from bytes input) is replaced with
+ * U+FFFD.
+ */
+static PyObject *
+unicode_character_at(const char *c, const char *end)
+{
+    /* A UTF-8 encoded character is at most 4 bytes long */
+    Py_ssize_t size = end - c < 4 ? end - c : 4;
+    PyObject *unicode_str = PyUnicode_DecodeUTF8(c, size, "replace");
+    PyObject *unicode_char;
+
+    if (unicode_str == NULL)
+        return NULL;
+    unicode_char = PyUnicode_Substring(unicode_str, 0, 1);
+    Py_DECREF(unicode_str);
+    return unicode_char;
+}
+
+/* Raises the ValueError describing why `str` failed to parse. `str` is only
+ * used by the errors that quote the input, so it may be NULL for the errors
+ * from `ciso8601_validate`.
+ */
+static int
+_raise_parse_error(const char *str, Py_ssize_t len,
+                   const ciso8601_result *result)
+{
+    const char *c;
+    PyObject *obj;
+
+    switch (result->error) {
+        case CISO8601_ERR_UNEXPECTED_END:
+            PyErr_Format(PyExc_ValueError,
+                         "Unexpected end of string while parsing %s. "
+                         "Expected %d more character%s",
+                         result->error_field, result->error_value,
+                         (result->error_value != 1) ? "s" : "");
+            break;
+        case CISO8601_ERR_INVALID_CHARACTER:
+            c = str + result->error_position;
+            if (*c == '-' && result->error_position == 0 &&
+                strcmp(result->error_field, "year") == 0) {
+                PyErr_SetString(
+                    PyExc_ValueError,
+                    "Invalid character while parsing year ('-', Index: 0). "
+                    "While valid ISO 8601 years, BCE years are not supported "
+                    "by Python's `datetime` objects.");
+                break;
+            }
+            obj = unicode_character_at(c, str + len);
+            if (obj == NULL)
+                return -1;
+            PyErr_Format(PyExc_ValueError,
+                         "Invalid character while parsing %s ('%U', Index: "
+                         "%zu)",
+                         result->error_field, obj, result->error_position);
+            Py_DECREF(obj);
+            break;
+        case CISO8601_ERR_TRAILING_CHARACTERS:
+            c = str + result->error_position;
+            obj = PyUnicode_DecodeUTF8(c, len - result->error_position,
+                                       "replace");
+            if (obj == NULL)
+                return -1;
+            PyErr_Format(PyExc_ValueError, "unconverted data remains: '%U'",
+                         obj);
+            Py_DECREF(obj);
+            break;
+        case CISO8601_ERR_ORDINAL_DAY_TOO_SMALL:
+        case CISO8601_ERR_ORDINAL_DAY_TOO_LARGE:
+            PyErr_Format(PyExc_ValueError,
+                         "Invalid ordinal day: %d is %s for year %d",
+                         result->error_value,
+                         result->error == CISO8601_ERR_ORDINAL_DAY_TOO_SMALL
+                             ? "too small"
+                             : "too large",
+                         result->year);
+            break;
+        case CISO8601_ERR_TZ_OFFSET_RANGE:
+            /* Matches the message of the datetime.timezone constructor */
+            obj = PyDelta_FromDSU(0, result->error_value * 60, 0);
+            if (obj == NULL)
+                return -1;
+            PyErr_Format(PyExc_ValueError,
+                         "offset must be a timedelta"
+                         " strictly between -timedelta(hours=24) and"
+                         " timedelta(hours=24),"
+                         " not %R.",
+                         obj);
+            Py_DECREF(obj);
+            break;
+        case CISO8601_ERR_YEAR_RANGE:
+            PyErr_Format(PyExc_ValueError, "year %i is out of range",
+                         result->year);
+            break;
+        default:
+            PyErr_SetString(PyExc_ValueError,
+                            ciso8601_strerror(result->error));
+            break;
+    }
+    return -1;
+}
+
+/* Parses `str` into `result` using the core parser (see parser.h), raising a
+ * ValueError on failure. In prefix mode (i.e., `consumed != NULL`), the
+ * number of bytes that make up the timestamp is stored in `consumed`.
+ */
+static int
+_parse_fields(const char *str, Py_ssize_t len, int parse_any_tzinfo,
+              int rfc3339_only, Py_ssize_t *consumed, ciso8601_result *result)
+{
+    int flags = 0;
+
+    if (!parse_any_tzinfo)
+        flags |= CISO8601_FLAG_NAIVE;
+    if (rfc3339_only)
+        flags |= CISO8601_FLAG_RFC3339;
+    if (consumed != NULL)
+        flags |= CISO8601_FLAG_PREFIX;
+
+    if (ciso8601_parse(str, (size_t)len, flags, result) != CISO8601_OK)
+        return _raise_parse_error(str, len, result);
+
+    if (consumed != NULL)
+        *consumed = (Py_ssize_t)result->consumed;
+    return 0;
+}
+
+/* Like `_parse_fields`, but for RFC 2822 dates (see `ciso8601_parse_rfc2822`
+ * for the `flags`)
+ */
+static int
+_parse_rfc2822_fields(const char *str, Py_ssize_t len, int flags,
+                      ciso8601_result *result)
+{
+    if (ciso8601_parse_rfc2822(str, (size_t)len, flags, result) !=
+        CISO8601_OK)
+        return _raise_parse_error(str, len, result);
+    return 0;
+}
+
+/* Returns a new reference to the tzinfo for the given UTC offset (in
+ * minutes), which must be in the range (-1440, 1440), exclusive.
+ */
+static PyObject *
+_get_tzinfo(int tzminute)
+{
+    PyObject *tzinfo;
+
+    if (tzminute == 0) {
+        Py_INCREF(utc);
+        return utc;
+    }
+#if CISO8601_CACHING_ENABLED
+    int tz_index = tzminute + 1439;
+    if ((tzinfo = tz_cache[tz_index]) == NULL) {
+        STATS_INC(tz_cache_misses);
+        tzinfo = new_fixed_offset(60 * tzminute);
+
+        if (tzinfo == NULL) /* i.e., PyErr_Occurred() */
+            return NULL;
+        tz_cache[tz_index] = tzinfo;
+    }
+    else {
+        STATS_INC(tz_cache_hits);
+    }
+    Py_INCREF(tzinfo);
+#else
+    tzinfo = new_fixed_offset(60 * tzminute);
+#endif
+    return tzinfo;
+}
+
+/* `_fixed_offset(offset)`: returns the FixedOffset for the given UTC offset
+ * (in seconds), reusing the cached instance if there is one. Unpickling
+ * FixedOffsets goes through this (see `FixedOffset.__reduce__`), so that it
+ * doesn't create a new tzinfo for every datetime.
+ */
+static PyObject *
+_fixed_offset(PyObject *self, PyObject *arg)
+{
+    long offset = PyLong_AsLong(arg);
+
+    if (offset == -1 && PyErr_Occurred())
+        return NULL;
+
+    if (labs(offset) >= 86400) {
+        PyErr_SetString(PyExc_ValueError,
+                        "offset must be an integer in the range (-86400, "
+                        "86400), exclusive");
+        return NULL;
+    }
+
+    /* `_get_tzinfo(0)` is the built-in UTC, which isn't a FixedOffset */
+    if (offset % 60 == 0 && offset != 0)
+        return _get_tzinfo((int)offset / 60);
+    return new_fixed_offset((int)offset);
+}
+
+static PyObject *
+_datetime_from_fields(const ciso8601_result *fields)
+{
+    PyObject *obj;
+    PyObject *tzinfo = Py_None;
+    PyObject *delta;
+    PyObject *temp;
+
+    if (fields->has_tzinfo) {
+        tzinfo = _get_tzinfo(fields->tzminute);
+        if (tzinfo == NULL)
+            return NULL;
+    }
+
+    obj = PyDateTimeAPI->DateTime_FromDateAndTime(
+        fields->year, fields->month, fields->day, fields->hour, fields->minute,
+        fields->second, fields->usecond, tzinfo, PyDateTimeAPI->DateTimeType);
+
+    if (fields->has_tzinfo)
+        Py_DECREF(tzinfo);
+
+#if CISO8601_STATS_ENABLED
+    if (obj == NULL) {
+        /* The datetime constructor did the validation, so count the error
+         * that `ciso8601_validate` would have found.
+         */
+        ciso8601_result copy = *fields;
+        ciso8601_validate(&copy);
+    }
+#endif
+
+    if (obj && fields->time_is_midnight) {
+        delta = PyDelta_FromDSU(1, 0, 0); /* 1 day */
+        temp = obj;
+        obj = PyNumber_Add(temp, delta);
+        Py_DECREF(delta);
+        Py_DECREF(temp);
+    }
+
+    return obj;
+}
+
+static PyObject *
+_parse(const char *str, Py_ssize_t len, int parse_any_tzinfo,
+       int rfc3339_only, Py_ssize_t *consumed)
+{
+    ciso8601_result fields;
+
+    if (_parse_fields(str, len, parse_any_tzinfo, rfc3339_only, consumed,
+                      &fields) < 0)
+        return NULL;
+
+    return _datetime_from_fields(&fields);
+}
+
+static const char *
+_as_utf8(PyObject *dtstr, Py_ssize_t *len)
+{
+    if (!PyUnicode_Check(dtstr)) {
+        PyErr_SetString(PyExc_TypeError, "argument must be str");
+        return NULL;
+    }
+
+    return PyUnicode_AsUTF8AndSize(dtstr, len);
+}
+
+static PyObject *
+_parse_str(PyObject *dtstr, int parse_any_tzinfo, int rfc3339_only)
+{
+    const char *str;
+    Py_ssize_t len;
+
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return NULL;
+
+    return _parse(str, len, parse_any_tzinfo, rfc3339_only, NULL);
+}
+
+static PyObject *
+parse_datetime_as_naive(PyObject *self, PyObject *dtstr)
+{
+    return _parse_str(dtstr, 0, 0);
+}
+
+static PyObject *
+_parse_datetime_in_zone(PyObject *const *args, Py_ssize_t nargs,
+                        PyObject *kwnames);
+
+static PyObject *
+parse_datetime(PyObject *self, PyObject *const *args, Py_ssize_t nargs,
+               PyObject *kwnames)
+{
+    /* Without `assume_tz`, this is as cheap as METH_O */
+    if (nargs == 1 && kwnames == NULL)
+        return _parse_str(args[0], 1, 0);
+    return _parse_datetime_in_zone(args, nargs, kwnames);
+}
+
+static PyObject *
+parse_rfc3339(PyObject *self, PyObject *dtstr)
+{
+    return _parse_str(dtstr, 1, 1);
+}
+
+static PyObject *
+_parse_rfc2822_str(PyObject *dtstr, int flags)
+{
+    const char *str;
+    Py_ssize_t len;
+    ciso8601_result fields;
+
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return NULL;
+
+    if (_parse_rfc2822_fields(str, len, flags, &fields) < 0)
+        return NULL;
+
+    return _datetime_from_fields(&fields);
+}
+
+static PyObject *
+parse_rfc2822(PyObject *self, PyObject *dtstr)
+{
+    return _parse_rfc2822_str(dtstr, 0);
+}
+
+static PyObject *
+parse_http_date(PyObject *self, PyObject *dtstr)
+{
+    return _parse_rfc2822_str(dtstr, CISO8601_FLAG_HTTP_DATE);
+}
+
+/* Parses the date or time only string `dtstr` with the given core parser
+ * `flags`
+ */
+static int
+_parse_part(PyObject *dtstr, int flags, ciso8601_result *fields)
+{
+    const char *str;
+    Py_ssize_t len;
+
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return -1;
+
+    if (ciso8601_parse(str, (size_t)len, flags, fields) != CISO8601_OK)
+        return _raise_parse_error(str, len, fields);
+    return 0;
+}
+
+static PyObject *
+parse_date(PyObject *self, PyObject *dtstr)
+{
+    ciso8601_result fields;
+
+    if (_parse_part(dtstr, CISO8601_FLAG_DATE_ONLY | CISO8601_FLAG_NAIVE,
+                    &fields) < 0)
+        return NULL;
+
+    return PyDate_FromDate(fields.year, fields.month, fields.day);
+}
+
+static PyObject *
+parse_time(PyObject *self, PyObject *dtstr)
+{
+    ciso8601_result fields;
+    PyObject *tzinfo = Py_None;
+    PyObject *obj;
+
+    if (_parse_part(dtstr, CISO8601_FLAG_TIME_ONLY, &fields) < 0)
+        return NULL;
+
+    /* Without a date, there is no following day for 24:00:00 to roll over to
+     */
+    if (fields.time_is_midnight) {
+        PyErr_SetString(PyExc_ValueError, "hour must be in 0..23");
+        return NULL;
+    }
+
+    if (fields.has_tzinfo) {
+        tzinfo = _get_tzinfo(fields.tzminute);
+        if (tzinfo == NULL)
+            return NULL;
+    }
+
+    obj = PyDateTimeAPI->Time_FromTime(fields.hour, fields.minute,
+                                       fields.second, fields.usecond, tzinfo,
+                                       PyDateTimeAPI->TimeType);
+
+    if (fields.has_tzinfo)
+        Py_DECREF(tzinfo);
+    return obj;
+}
+
+/* Returns the byte offset of the `index`th code point of the UTF-8 encoded
+ * `str`, or `len` if there are fewer code points than that.
+ */
+static Py_ssize_t
+utf8_offset_of(const char *str, Py_ssize_t len, Py_ssize_t index)
+{
+    Py_ssize_t offset = 0;
+
+    while (offset < len) {
+        /* Each code point begins with a byte that isn't a continuation byte */
+        if (((unsigned char)str[offset] & 0xC0) != 0x80 && index-- == 0)
+            break;
+        offset++;
+    }
+    return offset;
+}
+
+static PyObject *
+parse_prefix(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"datetime_string", "pos", "endpos", NULL};
+    PyObject *dtstr;
+    PyObject *endpos_obj = Py_None;
+    Py_ssize_t pos = 0, endpos = PY_SSIZE_T_MAX;
+    Py_ssize_t length, char_length, start, stop, consumed = 0;
+    const char *str;
+    Py_buffer view;
+    PyObject *obj;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nO:parse_prefix",
+                                     kwlist, &dtstr, &pos, &endpos_obj))
+        return NULL;
+
+    if (endpos_obj != Py_None) {
+        endpos = PyNumber_AsSsize_t(endpos_obj, PyExc_OverflowError);
+        if (endpos == -1 && PyErr_Occurred())
+            return NULL;
+    }
+
+    if (PyUnicode_Check(dtstr)) {
+        view.obj = NULL;
+        str = PyUnicode_AsUTF8AndSize(dtstr, &length);
+        if (str == NULL)
+            return NULL;
+        char_length = PyUnicode_GetLength(dtstr);
+    }
+    else if (PyObject_GetBuffer(dtstr, &view, PyBUF_SIMPLE) == 0) {
+        str = view.buf;
+        length = char_length = view.len;
+    }
+    else {
+        PyErr_SetString(PyExc_TypeError,
+                        "argument must be str or a bytes-like object");
+        return NULL;
+    }
+
+    /* Like `re.Pattern.match`, `pos` and `endpos` are indices into the
+     * original string (i.e., code points for str, bytes otherwise) and are
+     * clamped to its bounds.
+     */
+    if (pos < 0)
+        pos = 0;
+    if (pos > char_length)
+        pos = char_length;
+    if (endpos > char_length)
+        endpos = char_length;
+    if (endpos < pos)
+        endpos = pos;
+
+    start = pos;
+    stop = endpos;
+    if (char_length != length) { /* Non-ASCII str */
+        start = utf8_offset_of(str, length, pos);
+        stop = start + utf8_offset_of(str + start, length - start,
+                                      endpos - pos);
+    }
+
+    obj = _parse(str + start, stop - start, 1, 0, &consumed);
+
+    if (view.obj != NULL)
+        PyBuffer_Release(&view);
+
+    if (obj == NULL)
+        return NULL;
+
+    /* The timestamp itself is always ASCII, so its length in code points
+     * matches its length in bytes.
+     */
+    return Py_BuildValue("(Nn)", obj, pos + consumed);
+}
+
+/* ------------------------------------------------------------- */
+
+/* `ymd_to_ord(1970, 1, 1)` */
+#define EPOCH_ORDINAL   719163
+/* `ymd_to_ord(9999, 12, 31)` */
+#define MAX_ORDINAL     3652059
+#define SECONDS_PER_DAY 86400
+
+/* Performs the same validation as the datetime constructor, for the code paths
+ * that don't build a datetime.
+ */
+static int
+_validate_fields(ciso8601_result *fields)
+{
+    if (ciso8601_validate(fields) != CISO8601_OK)
+        return _raise_parse_error(NULL, 0, fields);
+    return 0;
+}
+
+static long long
+_floor_div(long long a, long long b)
+{
+    long long q = a / b;
+
+    if (a % b != 0 && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+/* Converts seconds since the epoch into an ordinal and the seconds into that
+ * day, failing if the ordinal isn't representable by a datetime.
+ */
+static int
+_epoch_to_ordinal(long long epoch, int *ordinal, int *seconds)
+{
+    long long days = _floor_div(epoch, SECONDS_PER_DAY);
+
+    if (days + EPOCH_ORDINAL < 1 || days + EPOCH_ORDINAL > MAX_ORDINAL) {
+        PyErr_SetString(PyExc_OverflowError, "date value out of range");
+        return -1;
+    }
+    *ordinal = (int)(days + EPOCH_ORDINAL);
+    *seconds = (int)(epoch - days * SECONDS_PER_DAY);
+    return 0;
+}
+
+typedef enum {
+    BUCKET_FIXED, /* A fixed number of seconds (minute, hour, day, N) */
+    BUCKET_WEEK,  /* ISO week, starting on Monday */
+    BUCKET_MONTH,
+} BucketKind;
+
+typedef struct {
+    BucketKind kind;
+    long long seconds;
+} BucketUnit;
+
+static int
+_parse_bucket_unit(PyObject *obj, BucketUnit *unit)
+{
+    static const struct {
+        const char *name;
+        BucketKind kind;
+        long long seconds;
+    } named_units[] = {
+        {"minute", BUCKET_FIXED, 60},
+        {"hour", BUCKET_FIXED, 3600},
+        {"day", BUCKET_FIXED, SECONDS_PER_DAY},
+        {"week", BUCKET_WEEK, 7 * SECONDS_PER_DAY},
+        {"month", BUCKET_MONTH, 0},
+    };
+    size_t i;
+
+    if (PyUnicode_Check(obj)) {
+        for (i = 0; i < sizeof(named_units) / sizeof(named_units[0]); i++) {
+            if (PyUnicode_CompareWithASCIIString(obj, named_units[i].name) ==
+                0) {
+                unit->kind = named_units[i].kind;
+                unit->seconds = named_units[i].seconds;
+                return 0;
+            }
+        }
+    }
+    /* A bool is an int, but `True` isn't a sensible number of seconds */
+    else if (PyLong_Check(obj) && !PyBool_Check(obj)) {
+        unit->kind = BUCKET_FIXED;
+        unit->seconds = PyLong_AsLongLong(obj);
+        if (unit->seconds == -1 && PyErr_Occurred())
+            return -1;
+        if (unit->seconds > 0)
+            return 0;
+    }
+
+    PyErr_Format(PyExc_ValueError,
+                 "unit must be one of 'minute', 'hour', 'day', 'week', "
+                 "'month' or a positive number of seconds, not %R",
+                 obj);
+    return -1;
+}
+
+/* Floors the epoch seconds to the start of its (UTC) bucket */
+static int
+_bucket_start(long long epoch, const BucketUnit *unit, long long *start)
+{
+    int ordinal, seconds, year, month, day;
+
+    switch (unit->kind) {
+        case BUCKET_WEEK:
+            ordinal = (int)_floor_div(epoch, SECONDS_PER_DAY) + EPOCH_ORDINAL;
+            /* 01-Jan-0001 was a Monday, so this rewinds to the Monday that
+             * starts the ISO week.
+             */
+            ordinal -= (ordinal + 6) % 7;
+            *start = (long long)(ordinal - EPOCH_ORDINAL) * SECONDS_PER_DAY;
+            return 0;
+        case BUCKET_MONTH:
+            if (_epoch_to_ordinal(epoch, &ordinal, &seconds) < 0)
+                return -1;
+            ord_to_ymd(ordinal, &year, &month, &day);
+            *start = (long long)(ymd_to_ord(year, month, 1) - EPOCH_ORDINAL) *
+                     SECONDS_PER_DAY;
+            return 0;
+        default:
+            *start = _floor_div(epoch, unit->seconds) * unit->seconds;
+            return 0;
+    }
+}
+
+static PyObject *
+_datetime_from_epoch(long long epoch, PyObject *tzinfo)
+{
+    int ordinal, seconds, year, month, day;
+
+    if (_epoch_to_ordinal(epoch, &ordinal, &seconds) < 0)
+        return NULL;
+    ord_to_ymd(ordinal, &year, &month, &day);
+
+    return PyDateTimeAPI->DateTime_FromDateAndTime(
+        year, month, day, seconds / 3600, seconds / 60 % 60, seconds % 60, 0,
+        tzinfo, PyDateTimeAPI->DateTimeType);
+}
+
+static PyObject *
+_parse_bucket(PyObject *dtstr, const BucketUnit *unit, int as_datetime)
+{
+    const char *str;
+    Py_ssize_t len;
+    ciso8601_result fields;
+    long long epoch, start;
+    int ordinal, seconds;
+
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return NULL;
+
+    if (_parse_fields(str, len, 1, 0, NULL, &fields) < 0 ||
+        _validate_fields(&fields) < 0)
+        return NULL;
+
+    /* As with `parse_datetime`, the local time must be representable (which
+     * 24:00 on 9999-12-31 isn't).
+     */
+    epoch = ciso8601_epoch_seconds(&fields);
+    if (_epoch_to_ordinal(epoch + fields.tzminute * 60, &ordinal, &seconds) <
+        0)
+        return NULL;
+
+    if (_bucket_start(epoch, unit, &start) < 0)
+        return NULL;
+
+    if (as_datetime)
+        return _datetime_from_epoch(start,
+                                    fields.has_tzinfo ? utc : Py_None);
+
+    return PyLong_FromLongLong(start);
+}
+
+static PyObject *
+parse_bucket(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"datetime_string", "unit", "as_datetime", NULL};
+    PyObject *dtstr, *unit_obj;
+    int as_datetime = 0;
+    BucketUnit unit;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|p:parse_bucket",
+                                     kwlist, &dtstr, &unit_obj, &as_datetime))
+        return NULL;
+
+    if (_parse_bucket_unit(unit_obj, &unit) < 0)
+        return NULL;
+
+    return _parse_bucket(dtstr, &unit, as_datetime);
+}
+
+/* ------------------------------------------------------------- */
+/* Time zones assumed for naive timestamps */
+
+/* The zones that were loaded so far, by key, as capsules of ciso8601_zone.
+ * They are kept for the lifetime of the process (there are only a few hundred
+ * of them).
+ */
+static PyObject *zones;
+
+#define ZONE_CAPSULE_NAME "ciso8601.zone"
+
+static void
+_free_zone_capsule(PyObject *capsule)
+{
+    ciso8601_zone *zone = PyCapsule_GetPointer(capsule, ZONE_CAPSULE_NAME);
+
+    if (zone != NULL) {
+        ciso8601_zone_free(zone);
+        PyMem_Free(zone);
+    }
+}
+
+/* Like zoneinfo, only accepts keys that are relative paths without `.` or
+ * `..` components, so that they can't refer to other files
+ */
+static int
+_check_zone_key(PyObject *key, const char **str)
+{
+    Py_ssize_t len, i, start = 0;
+    const char *c;
+    char ch;
+
+    if (!PyUnicode_Check(key)) {
+        PyErr_Format(PyExc_TypeError, "assume_tz must be a str, not %.200s",
+                     Py_TYPE(key)->tp_name);
+        return -1;
+    }
+    if ((c = PyUnicode_AsUTF8AndSize(key, &len)) == NULL)
+        return -1;
+
+    for (i = 0; i <= len; i++) {
+        if (i == len || c[i] == '/') {
+            if (i == start || (i - start == 1 && c[start] == '.') ||
+                (i - start == 2 && c[start] == '.' && c[start + 1] == '.'))
+                goto invalid;
+            start = i + 1;
+            continue;
+        }
+        ch = c[i];
+        if (!((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
+              (ch >= '0' && ch <= '9') || ch == '_' || ch == '-' ||
+              ch == '+' || ch == '.'))
+            goto invalid;
+    }
+    *str = c;
+    return 0;
+
+invalid:
+    PyErr_Format(PyExc_ValueError, "Invalid time zone key %R", key);
+    return -1;
+}
+
+/* Returns the contents of `path`, or NULL without an exception set if it
+ * can't be read
+ */
+static PyObject *
+_read_file(PyObject *path)
+{
+    PyObject *io, *file, *data, *rv;
+
+    if ((io = PyImport_ImportModule("io")) == NULL)
+        return NULL;
+    file = PyObject_CallMethod(io, "open", "Os", path, "rb");
+    Py_DECREF(io);
+    if (file == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_OSError))
+            PyErr_Clear();
+        return NULL;
+    }
+
+    data = PyObject_CallMethod(file, "read", NULL);
+    rv = PyObject_CallMethod(file, "close", NULL);
+    Py_XDECREF(rv);
+    Py_DECREF(file);
+    if (rv == NULL)
+        Py_CLEAR(data);
+    return data;
+}
+
+/* Reads the TZif file of `key` from the first directory of zoneinfo's TZPATH
+ * that has it, or else from the `tzdata` package, as zoneinfo would. Returns
+ * NULL without an exception set if there isn't one.
+ */
+static PyObject *
+_read_zone_file(PyObject *key, const char *key_str)
+{
+    static const char *const default_tzpath[] = {
+        "/usr/share/zoneinfo", "/usr/lib/zoneinfo", "/usr/share/lib/zoneinfo",
+        "/etc/zoneinfo"};
+    PyObject *module, *tzpath, *path, *package, *resource, *files;
+    PyObject *data = NULL;
+    const char *slash = strrchr(key_str, '/');
+    Py_ssize_t i;
+
+    /* zoneinfo (Python 3.9+) knows about PYTHONTZPATH and the TZPATH that
+     * Python was built with
+     */
+    if ((module = PyImport_ImportModule("zoneinfo")) != NULL) {
+        tzpath = PyObject_GetAttrString(module, "TZPATH");
+        Py_DECREF(module);
+    }
+    else if (PyErr_ExceptionMatches(PyExc_ImportError)) {
+        PyErr_Clear();
+        tzpath = Py_BuildValue("(ssss)", default_tzpath[0], default_tzpath[1],
+                               default_tzpath[2], default_tzpath[3]);
+    }
+    else {
+        return NULL;
+    }
+    if (tzpath == NULL)
+        return NULL;
+    if (!PyTuple_Check(tzpath)) {
+        PyErr_SetString(PyExc_TypeError, "zoneinfo.TZPATH must be a tuple");
+        Py_DECREF(tzpath);
+        return NULL;
+    }
+
+    for (i = 0; data == NULL && i < PyTuple_GET_SIZE(tzpath); i++) {
+        path = PyUnicode_FromFormat("%S/%U", PyTuple_GET_ITEM(tzpath, i), key);
+        if (path == NULL)
+            break;
+        data = _read_file(path);
+        Py_DECREF(path);
+        if (PyErr_Occurred())
+            break;
+    }
+    Py_DECREF(tzpath);
+    if (data != NULL || PyErr_Occurred())
+        return data;
+
+    /* `tzdata` has a package for each directory of zones */
+    if (slash != NULL) {
+        path = PyUnicode_FromFormat("tzdata.zoneinfo.%.*s",
+                                    (int)(slash - key_str), key_str);
+        package = path != NULL
+                      ? PyObject_CallMethod(path, "replace", "ss", "/", ".")
+                      : NULL;
+        Py_XDECREF(path);
+    }
+    else {
+        package = PyUnicode_FromString("tzdata.zoneinfo");
+    }
+    resource = PyUnicode_FromString(slash != NULL ? slash + 1 : key_str);
+    module = PyImport_ImportModule("importlib.resources");
+    if (package == NULL || resource == NULL || module == NULL)
+        goto done;
+
+    if (PyObject_HasAttrString(module, "files")) {
+        files = PyObject_CallMethod(module, "files", "O", package);
+        path = files != NULL
+                   ? PyObject_CallMethod(files, "joinpath", "O", resource)
+                   : NULL;
+        data = path != NULL ? PyObject_CallMethod(path, "read_bytes", NULL)
+                            : NULL;
+        Py_XDECREF(files);
+        Py_XDECREF(path);
+    }
+    else { /* Python 3.8 */
+        data = PyObject_CallMethod(module, "read_binary", "OO", package,
+                                   resource);
+    }
+    if (data == NULL && (PyErr_ExceptionMatches(PyExc_ImportError) ||
+                         PyErr_ExceptionMatches(PyExc_OSError)))
+        PyErr_Clear();
+
+done:
+    Py_XDECREF(package);
+    Py_XDECREF(resource);
+    Py_XDECREF(module);
+    return data;
+}
+
+/* Returns the zone of `key`, loading it the first time */
+static const ciso8601_zone *
+_get_zone(PyObject *key)
+{
+    PyObject *capsule, *data;
+    ciso8601_zone *zone;
+    ciso8601_zone_error error;
+    const char *key_str;
+
+    if (zones == NULL && (zones = PyDict_New()) == NULL)
+        return NULL;
+    if ((capsule = PyDict_GetItemWithError(zones, key)) != NULL)
+        return PyCapsule_GetPointer(capsule, ZONE_CAPSULE_NAME);
+    if (PyErr_Occurred() || _check_zone_key(key, &key_str) < 0)
+        return NULL;
+
+    if ((data = _read_zone_file(key, key_str)) == NULL) {
+        if (!PyErr_Occurred())
+            PyErr_Format(PyExc_ValueError, "No time zone found with key %U",
+                         key);
+        return NULL;
+    }
+    if (!PyBytes_Check(data)) {
+        PyErr_Format(PyExc_TypeError,
+                     "Time zone data must be bytes, not %.200s",
+                     Py_TYPE(data)->tp_name);
+        Py_DECREF(data);
+        return NULL;
+    }
+
+    if ((zone = PyMem_New(ciso8601_zone, 1)) == NULL) {
+        Py_DECREF(data);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    error = ciso8601_zone_load((const unsigned char *)PyBytes_AS_STRING(data),
+                               PyBytes_GET_SIZE(data), zone);
+    Py_DECREF(data);
+    if (error != CISO8601_ZONE_OK) {
+        PyMem_Free(zone);
+        if (error == CISO8601_ZONE_NO_MEMORY)
+            PyErr_NoMemory();
+        else
+            PyErr_Format(PyExc_ValueError,
+                         "Invalid TZif data for time zone %U", key);
+        return NULL;
+    }
+
+    capsule = PyCapsule_New(zone, ZONE_CAPSULE_NAME, _free_zone_capsule);
+    if (capsule == NULL) {
+        ciso8601_zone_free(zone);
+        PyMem_Free(zone);
+        return NULL;
+    }
+    if (PyDict_SetItem(zones, key, capsule) < 0)
+        zone = NULL;
+    Py_DECREF(capsule);
+    return zone;
+}
+
+/* How local times that are ambiguous or nonexistent are resolved: with the
+ * offset before the transition they are in (like `fold=0`), the offset after
+ * it (like `fold=1`), or by raising a ValueError
+ */
+typedef enum {
+    LOCAL_OFFSET_BEFORE,
+    LOCAL_OFFSET_AFTER,
+    LOCAL_RAISE,
+} LocalPolicy;
+
+typedef struct {
+    PyObject *key;
+    const ciso8601_zone *zone;
+    LocalPolicy ambiguous, nonexistent;
+} AssumedZone;
+
+/* Sets up `tz` from the `assume_tz`, `ambiguous` and `nonexistent`
+ * arguments. `tz->zone` is left NULL if `key` is None.
+ */
+static int
+_get_assumed_zone(PyObject *key, const char *ambiguous,
+                  const char *nonexistent, AssumedZone *tz)
+{
+    tz->key = key;
+    tz->zone = NULL;
+
+    if (strcmp(ambiguous, "earlier") == 0) {
+        tz->ambiguous = LOCAL_OFFSET_BEFORE;
+    }
+    else if (strcmp(ambiguous, "later") == 0) {
+        tz->ambiguous = LOCAL_OFFSET_AFTER;
+    }
+    else if (strcmp(ambiguous, "raise") == 0) {
+        tz->ambiguous = LOCAL_RAISE;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "ambiguous must be 'earlier', 'later' or 'raise', not "
+                     "'%s'",
+                     ambiguous);
+        return -1;
+    }
+
+    if (strcmp(nonexistent, "shift_forward") == 0) {
+        tz->nonexistent = LOCAL_OFFSET_BEFORE;
+    }
+    else if (strcmp(nonexistent, "shift_backward") == 0) {
+        tz->nonexistent = LOCAL_OFFSET_AFTER;
+    }
+    else if (strcmp(nonexistent, "raise") == 0) {
+        tz->nonexistent = LOCAL_RAISE;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "nonexistent must be 'shift_forward', 'shift_backward' "
+                     "or 'raise', not '%s'",
+                     nonexistent);
+        return -1;
+    }
+
+    if (key != Py_None && (tz->zone = _get_zone(key)) == NULL)
+        return -1;
+    return 0;
+}
+
+/* Resolves the naive `fields` as a local time in `tz`, into its UTC epoch
+ * seconds and the offset in effect at that instant (which, for a nonexistent
+ * time, isn't the offset that it was resolved with). Returns the kind of the
+ * local time if the policy for it is to raise, or else
+ * CISO8601_LOCAL_UNIQUE.
+ */
+static ciso8601_local_time
+_localize(const AssumedZone *tz, const ciso8601_result *fields,
+          int64_t *epoch, int32_t *offset)
+{
+    int64_t local = ciso8601_epoch_seconds(fields);
+    int32_t before, after;
+    ciso8601_local_time kind;
+    LocalPolicy policy;
+
+    kind = ciso8601_zone_offsets(tz->zone, local, &before, &after);
+    policy = kind == CISO8601_LOCAL_AMBIGUOUS     ? tz->ambiguous
+             : kind == CISO8601_LOCAL_NONEXISTENT ? tz->nonexistent
+                                                  : LOCAL_OFFSET_BEFORE;
+    if (policy == LOCAL_RAISE)
+        return kind;
+
+    *epoch = local - (policy == LOCAL_OFFSET_BEFORE ? before : after);
+    if (kind == CISO8601_LOCAL_NONEXISTENT)
+        *offset = policy == LOCAL_OFFSET_BEFORE ? after : before;
+    else
+        *offset = policy == LOCAL_OFFSET_BEFORE ? before : after;
+    return CISO8601_LOCAL_UNIQUE;
+}
+
+static void
+_raise_local_time_error(PyObject *dtstr, const AssumedZone *tz,
+                        ciso8601_local_time kind)
+{
+    PyErr_Format(PyExc_ValueError, "%R is %s local time in %U", dtstr,
+                 kind == CISO8601_LOCAL_AMBIGUOUS ? "an ambiguous"
+                                                  : "a nonexistent",
+                 tz->key);
+}
+
+/* The value of a str keyword argument */
+static const char *
+_str_argument(PyObject *value, const char *name)
+{
+    if (!PyUnicode_Check(value)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a str, not %.200s", name,
+                     Py_TYPE(value)->tp_name);
+        return NULL;
+    }
+    return PyUnicode_AsUTF8(value);
+}
+
+/* `parse_datetime` with keyword arguments. They are parsed by hand, rather
+ * than with PyArg_ParseTupleAndKeywords (which needs them as a dict), as the
+ * point of `assume_tz` is to be cheaper than localizing afterwards.
+ */
+static PyObject *
+_parse_datetime_in_zone(PyObject *const *args, Py_ssize_t nargs,
+                        PyObject *kwnames)
+{
+    PyObject *key = Py_None, *name, *value, *tzinfo, *result;
+    const char *ambiguous = "earlier", *nonexistent = "shift_forward";
+    const char *str;
+    Py_ssize_t len, i;
+    ciso8601_result fields;
+    ciso8601_local_time kind;
+    AssumedZone tz;
+    int64_t epoch;
+    int32_t offset;
+    int ordinal, seconds, year, month, day;
+
+    if (nargs != 1) {
+        PyErr_Format(PyExc_TypeError,
+                     "parse_datetime() takes exactly 1 positional argument "
+                     "(%zd given)",
+                     nargs);
+        return NULL;
+    }
+    for (i = 0; kwnames != NULL && i < PyTuple_GET_SIZE(kwnames); i++) {
+        name = PyTuple_GET_ITEM(kwnames, i);
+        value = args[nargs + i];
+        if (PyUnicode_CompareWithASCIIString(name, "assume_tz") == 0) {
+            key = value;
+        }
+        else if (PyUnicode_CompareWithASCIIString(name, "ambiguous") == 0) {
+            if ((ambiguous = _str_argument(value, "ambiguous")) == NULL)
+                return NULL;
+        }
+        else if (PyUnicode_CompareWithASCIIString(name, "nonexistent") ==
+                 0) {
+            if ((nonexistent = _str_argument(value, "nonexistent")) == NULL)
+                return NULL;
+        }
+        else {
+            PyErr_Format(PyExc_TypeError,
+                         "parse_datetime() got an unexpected keyword argument "
+                         "'%U'",
+                         name);
+            return NULL;
+        }
+    }
+    if (_get_assumed_zone(key, ambiguous, nonexistent, &tz) < 0)
+        return NULL;
+
+    if ((str = _as_utf8(args[0], &len)) == NULL ||
+        _parse_fields(str, len, 1, 0, NULL, &fields) < 0)
+        return NULL;
+    if (tz.zone == NULL || fields.has_tzinfo)
+        return _datetime_from_fields(&fields);
+
+    if (_validate_fields(&fields) < 0)
+        return NULL;
+    if ((kind = _localize(&tz, &fields, &epoch, &offset)) !=
+        CISO8601_LOCAL_UNIQUE) {
+        _raise_local_time_error(args[0], &tz, kind);
+        return NULL;
+    }
+
+    /* Nonexistent times are shifted, so the local time is rebuilt */
+    if (_epoch_to_ordinal(epoch + offset, &ordinal, &seconds) < 0)
+        return NULL;
+    ord_to_ymd(ordinal, &year, &month, &day);
+
+    /* Offsets with seconds (such as LMT) are too rare to be worth caching */
+    tzinfo = offset % 60 == 0 ? _get_tzinfo(offset / 60)
+                              : new_fixed_offset(offset);
+    if (tzinfo == NULL)
+        return NULL;
+    result = PyDateTimeAPI->DateTime_FromDateAndTime(
+        year, month, day, seconds / 3600, seconds / 60 % 60, seconds % 60,
+        fields.usecond, tzinfo, PyDateTimeAPI->DateTimeType);
+    Py_DECREF(tzinfo);
+    return result;
+}
+
+/* Factorizing the strings of a batch (`dedupe=True`), so that each distinct
+ * string is only parsed once and its result is shared by all of the rows that
+ * have it. The table only lives for the duration of one call.
+ */
+
+typedef struct {
+    const char *str;
+    Py_ssize_t len;
+    /* Of the first row with the string, or -1 if the slot is empty */
+    Py_ssize_t index;
+    uint64_t hash;
+} DedupeEntry;
+
+typedef struct {
+    DedupeEntry *entries;
+    size_t mask;
+    Py_ssize_t count;
+} DedupeTable;
+
+#define DEDUPE_INITIAL_SIZE 64
+
+static int
+_dedupe_init(DedupeTable *table, size_t size)
+{
+    size_t i;
+
+    table->entries = PyMem_New(DedupeEntry, size);
+    if (table->entries == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (i = 0; i < size; i++) table->entries[i].index = -1;
+    table->mask = size - 1;
+    table->count = 0;
+    return 0;
+}
+
+static void
+_dedupe_free(DedupeTable *table)
+{
+    PyMem_Free(table->entries);
+    table->entries = NULL;
+}
+
+/* Hashes 8 bytes at a time (with the mixing steps of splitmix64), as
+ * timestamps are too short for a byte at a time to be worth it. It only needs
+ * to be consistent within a call, so the byte order doesn't matter.
+ */
+static uint64_t
+_dedupe_hash(const char *str, Py_ssize_t len)
+{
+    uint64_t hash = (uint64_t)len * 0x9e3779b97f4a7c15ULL, word;
+
+    for (; len > 0; str += 8, len -= 8) {
+        word = 0;
+        memcpy(&word, str, len < 8 ? (size_t)len : 8);
+        hash = (hash ^ word) * 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 31;
+    }
+    hash *= 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 29);
+}
+
+/* Returns the index of the first row with `str`, which is `index` (and `str`
+ * is added to the table) if there wasn't one yet. The strings must outlive
+ * the table. Returns -1 with an exception set on failure.
+ */
+static Py_ssize_t
+_dedupe_lookup(DedupeTable *table, const char *str, Py_ssize_t len,
+               Py_ssize_t index)
+{
+    DedupeTable grown;
+    DedupeEntry *entry;
+    uint64_t hash = _dedupe_hash(str, len);
+    size_t i = (size_t)hash & table->mask;
+    size_t j;
+
+    /* Linear probing, which the table being at most half full keeps short */
+    for (;; i = (i + 1) & table->mask) {
+        entry = &table->entries[i];
+        if (entry->index < 0)
+            break;
+        if (entry->hash == hash && entry->len == len &&
+            (entry->str == str || memcmp(entry->str, str, len) == 0))
+            return entry->index;
+    }
+
+    entry->str = str;
+    entry->len = len;
+    entry->index = index;
+    entry->hash = hash;
+
+    if ((size_t)++table->count * 2 > table->mask) {
+        if (_dedupe_init(&grown, (table->mask + 1) * 2) < 0)
+            return -1;
+        for (j = 0; j <= table->mask; j++) {
+            if (table->entries[j].index < 0)
+                continue;
+            i = (size_t)table->entries[j].hash & grown.mask;
+            while (grown.entries[i].index >= 0) i = (i + 1) & grown.mask;
+            grown.entries[i] = table->entries[j];
+        }
+        grown.count = table->count;
+        _dedupe_free(table);
+        *table = grown;
+    }
+    return index;
+}
+
+/* Gets the buffer of `out` that `count` int64 values are written to, starting
+ * at index `offset`. Any writable, contiguous buffer of native 64-bit signed
+ * integers works (e.g., an `array.array('q')`, a NumPy int64 array, or a
+ * `multiprocessing.shared_memory` block's `buf.cast('q')`).
+ */
+static int
+_get_int64_buffer(PyObject *out, Py_ssize_t offset, Py_ssize_t count,
+                  Py_buffer *view)
+{
+    const char *format;
+
+    if (PyObject_GetBuffer(out, view,
+                           PyBUF_WRITABLE | PyBUF_FORMAT |
+                               PyBUF_C_CONTIGUOUS) < 0)
+        return -1;
+
+    format = view->format;
+    if (format[0] == '@' || format[0] == '=')
+        format++;
+    if (view->itemsize != sizeof(int64_t) ||
+        (strcmp(format, "q") != 0 &&
+         !(strcmp(format, "l") == 0 && sizeof(long) == sizeof(int64_t)))) {
+        PyErr_Format(PyExc_TypeError,
+                     "out must be a buffer of 64-bit signed integers "
+                     "(format 'q'), not '%s'",
+                     view->format);
+        PyBuffer_Release(view);
+        return -1;
+    }
+
+    if (offset < 0 || offset > view->len / view->itemsize - count) {
+        PyErr_Format(PyExc_ValueError,
+                     "out has room for %zd values, but %zd were needed at "
+                     "offset %zd",
+                     view->len / view->itemsize, count, offset);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+_append_index(PyObject *errors, Py_ssize_t index)
+{
+    PyObject *obj = PyLong_FromSsize_t(index);
+
+    if (obj == NULL || PyList_Append(errors, obj) < 0) {
+        Py_XDECREF(obj);
+        return -1;
+    }
+    Py_DECREF(obj);
+    return 0;
+}
+
+/* Parses `str` into `*value` for the `out` buffers: the epoch microseconds,
+ * or the start of the bucket if `unit` is given. Naive timestamps are
+ * localized to `tz` if it has a zone. Returns 1 on success, or 0 (without
+ * raising) if `str` isn't a valid, representable timestamp (or is a local time
+ * that the policy of `tz` rejects), in which case `*value` is set to
+ * INT64_MIN and `index` is appended to `errors`. Returns -1 with an exception
+ * set on any other error.
+ */
+static int
+_parse_int64(const char *str, Py_ssize_t len, const BucketUnit *unit,
+             const AssumedZone *tz, int64_t *value, PyObject *errors,
+             Py_ssize_t index)
+{
+    ciso8601_result fields;
+    long long start;
+    int64_t epoch;
+    int32_t offset;
+    int ordinal, seconds;
+
+    if (ciso8601_parse(str, (size_t)len, 0, &fields) == CISO8601_OK &&
+        ciso8601_validate(&fields) == CISO8601_OK) {
+        /* As with `parse_datetime`, the local time must be representable
+         * (which 24:00 on 9999-12-31 isn't)
+         */
+        epoch = ciso8601_epoch_seconds(&fields);
+        if (_epoch_to_ordinal(epoch + fields.tzminute * 60, &ordinal,
+                              &seconds) < 0) {
+            PyErr_Clear();
+            goto invalid;
+        }
+        if (tz != NULL && tz->zone != NULL && !fields.has_tzinfo &&
+            _localize(tz, &fields, &epoch, &offset) != CISO8601_LOCAL_UNIQUE)
+            goto invalid;
+        if (unit == NULL) {
+            *value = epoch * 1000000 + fields.usecond;
+            return 1;
+        }
+        if (_bucket_start(epoch, unit, &start) == 0) {
+            *value = start;
+            return 1;
+        }
+        if (!PyErr_ExceptionMatches(PyExc_OverflowError))
+            return -1;
+        PyErr_Clear();
+    }
+
+invalid:
+    *value = INT64_MIN;
+    return _append_index(errors, index);
+}
+
+/* Fills row `index` of an `out` buffer with the value of the earlier row
+ * `first`, which had the same string (see `_parse_int64`)
+ */
+static int
+_reuse_int64(int64_t *values, Py_ssize_t index, Py_ssize_t first,
+             PyObject *errors)
+{
+    values[index] = values[first];
+    if (values[index] != INT64_MIN)
+        return 1;
+    return _append_index(errors, index);
+}
+
+/* Parses each of `dtstrs` into `out[offset:]` (see `_parse_int64`). Nothing
+ * is allocated per string (other than for the ones that fail to parse), so
+ * that batches can be parsed straight into shared memory.
+ *
+ * Returns the number of values that were parsed, and the indices of the
+ * strings that weren't (and the number of distinct strings if `dedupe`).
+ */
+static PyObject *
+_parse_many_into(PyObject *dtstrs, PyObject *out, Py_ssize_t offset,
+                 const BucketUnit *unit, const AssumedZone *tz, int dedupe)
+{
+    PyObject *seq, *errors;
+    PyObject *result = NULL;
+    Py_buffer view;
+    DedupeTable table = {NULL};
+    int64_t *values;
+    Py_ssize_t i, count, first, parsed = 0;
+    const char *str;
+    Py_ssize_t len;
+    int rv;
+
+    seq = PySequence_Fast(dtstrs, "argument must be iterable");
+    if (seq == NULL)
+        return NULL;
+
+    count = PySequence_Fast_GET_SIZE(seq);
+    if (_get_int64_buffer(out, offset, count, &view) < 0) {
+        Py_DECREF(seq);
+        return NULL;
+    }
+    values = (int64_t *)view.buf + offset;
+
+    errors = PyList_New(0);
+    if (errors == NULL ||
+        (dedupe && _dedupe_init(&table, DEDUPE_INITIAL_SIZE) < 0))
+        goto error;
+
+    for (i = 0; i < count; i++) {
+        if ((str = _as_utf8(PySequence_Fast_GET_ITEM(seq, i), &len)) == NULL)
+            goto error;
+        first = dedupe ? _dedupe_lookup(&table, str, len, i) : i;
+        if (first < 0)
+            goto error;
+        if (first < i)
+            rv = _reuse_int64(values, i, first, errors);
+        else
+            rv = _parse_int64(str, len, unit, tz, &values[i], errors, i);
+        if (rv < 0)
+            goto error;
+        parsed += rv;
+    }
+
+    if (dedupe)
+        result = Py_BuildValue("(nOn)", parsed, errors, table.count);
+    else
+        result = Py_BuildValue("(nO)", parsed, errors);
+
+error:
+    _dedupe_free(&table);
+    Py_XDECREF(errors);
+    PyBuffer_Release(&view);
+    Py_DECREF(seq);
+    return result;
+}
+
+static PyObject *
+parse_bucket_many(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"datetime_strings", "unit",   "as_datetime",
+                             "out",              "offset", "dedupe",
+                             NULL};
+    PyObject *dtstrs, *unit_obj, *seq, *result = NULL, *list, *item;
+    PyObject *out = Py_None;
+    int as_datetime = 0, dedupe = 0;
+    BucketUnit unit;
+    DedupeTable table = {NULL};
+    Py_ssize_t i, count, first, offset = 0, len;
+    const char *str;
+
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "OO|p$Onp:parse_bucket_many", kwlist, &dtstrs,
+            &unit_obj, &as_datetime, &out, &offset, &dedupe))
+        return NULL;
+
+    if (_parse_bucket_unit(unit_obj, &unit) < 0)
+        return NULL;
+
+    if (out != Py_None) {
+        if (as_datetime) {
+            PyErr_SetString(PyExc_ValueError,
+                            "as_datetime can't be used with out");
+            return NULL;
+        }
+        return _parse_many_into(dtstrs, out, offset, &unit, NULL, dedupe);
+    }
+
+    seq = PySequence_Fast(dtstrs, "argument must be iterable");
+    if (seq == NULL)
+        return NULL;
+
+    count = PySequence_Fast_GET_SIZE(seq);
+    list = PyList_New(count);
+    if (list == NULL ||
+        (dedupe && _dedupe_init(&table, DEDUPE_INITIAL_SIZE) < 0))
+        goto error;
+
+    for (i = 0; i < count; i++) {
+        item = PySequence_Fast_GET_ITEM(seq, i);
+        first = i;
+        if (dedupe) {
+            if ((str = _as_utf8(item, &len)) == NULL ||
+                (first = _dedupe_lookup(&table, str, len, i)) < 0)
+                goto error;
+        }
+        /* Rows with the same string share the same (immutable) result */
+        if (first < i) {
+            item = PyList_GET_ITEM(list, first);
+            Py_INCREF(item);
+        }
+        else if ((item = _parse_bucket(item, &unit, as_datetime)) == NULL) {
+            goto error;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    if (dedupe) {
+        result = Py_BuildValue("(On)", list, table.count);
+    }
+    else {
+        result = list;
+        list = NULL;
+    }
+
+error:
+    _dedupe_free(&table);
+    Py_XDECREF(list);
+    Py_DECREF(seq);
+    return result;
+}
+
+static PyObject *
+parse_epoch_many(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"datetime_strings", "out",         "offset",
+                             "assume_tz",        "ambiguous",   "nonexistent",
+                             "dedupe",           NULL};
+    PyObject *dtstrs, *out, *key = Py_None;
+    const char *ambiguous = "earlier", *nonexistent = "shift_forward";
+    Py_ssize_t offset = 0;
+    int dedupe = 0;
+    AssumedZone tz;
+
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "OO|n$Ossp:parse_epoch_many", kwlist, &dtstrs, &out,
+            &offset, &key, &ambiguous, &nonexistent, &dedupe))
+        return NULL;
+
+    if (_get_assumed_zone(key, ambiguous, nonexistent, &tz) < 0)
+        return NULL;
+
+    return _parse_many_into(dtstrs, out, offset, NULL, &tz, dedupe);
+}
+
+/* Delimited (e.g., CSV) columns */
+
+/* Finds field `column` of the record that starts at `*pos`, and advances
+ * `*pos` to the start of the next record. Quoted fields may contain
+ * delimiters and line breaks, and records may end with "\n", "\r\n" or
+ * "\r". A quoted field is returned without its quotes (but with any escaped
+ * `""` as is, since they can't be part of a timestamp anyway).
+ *
+ * Returns 0 if the record doesn't have that many fields.
+ */
+static int
+_find_field(const char *buf, Py_ssize_t len, Py_ssize_t *pos,
+            Py_ssize_t column, char delimiter, int quotechar,
+            const char **field, Py_ssize_t *field_len)
+{
+    Py_ssize_t i = *pos, n = 0, start, stop;
+    const char *quote;
+    int found = 0, quoted;
+
+    for (;;) {
+        quoted = quotechar >= 0 && i < len && buf[i] == quotechar;
+        start = quoted ? ++i : i;
+        if (quoted) {
+            /* An unterminated quoted field goes up to the end */
+            stop = len;
+            while ((quote = memchr(buf + i, quotechar, len - i)) != NULL) {
+                i = quote - buf + 1;
+                if (i < len && buf[i] == quotechar) { /* An escaped quote */
+                    i++;
+                    continue;
+                }
+                stop = i - 1;
+                break;
+            }
+            if (quote == NULL)
+                i = len;
+        }
+        /* Like the csv module, anything between a closing quote and the
+         * delimiter is ignored
+         */
+        while (i < len && buf[i] != delimiter && buf[i] != '\n' &&
+               buf[i] != '\r')
+            i++;
+        if (!quoted)
+            stop = i;
+
+        if (n == column) {
+            *field = buf + start;
+            *field_len = stop - start;
+            found = 1;
+        }
+        if (i >= len || buf[i] != delimiter)
+            break;
+        i++;
+        n++;
+    }
+
+    if (i < len && buf[i] == '\r')
+        i++;
+    if (i < len && buf[i] == '\n')
+        i++;
+    *pos = i;
+    return found;
+}
+
+/* Replaces the pending ValueError with one that says which record it is
+ * about
+ */
+static void
+_add_record_to_error(Py_ssize_t record)
+{
+    PyObject *value;
+
+    if (!PyErr_ExceptionMatches(PyExc_ValueError))
+        return;
+
+#if PY_VERSION_HEX >= 0x030C0000
+    value = PyErr_GetRaisedException();
+#else
+    PyObject *type, *traceback;
+
+    PyErr_Fetch(&type, &value, &traceback);
+    PyErr_NormalizeException(&type, &value, &traceback);
+    Py_XDECREF(type);
+    Py_XDECREF(traceback);
+#endif
+    PyErr_Format(PyExc_ValueError, "Record %zd: %S", record, value);
+    Py_XDECREF(value);
+}
+
+static PyObject *
+parse_delimited_column(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"buffer", "column", "delimiter", "quotechar",
+                             "out",    "offset", "dedupe",    "skip_rows",
+                             NULL};
+    Py_buffer buffer, view;
+    Py_ssize_t column = 3, offset = 0, pos = 0, record = 0, parsed = 0;
+    Py_ssize_t skip_rows = 0;
+    Py_ssize_t room = 0, field_len = 0, first;
+    char delimiter = ',';
+    PyObject *quotechar_obj = NULL, *out = Py_None;
+    PyObject *values = NULL, *errors = NULL, *obj;
+    PyObject *result = NULL;
+    const char *buf, *field = NULL;
+    int quotechar = '"', dedupe = 0, rv;
+    DedupeTable table = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "y*|ncO$Onpn:parse_delimited_column", kwlist,
+            &buffer, &column, &delimiter, &quotechar_obj, &out, &offset,
+            &dedupe, &skip_rows))
+        return NULL;
+    view.obj = NULL;
+
+    if (quotechar_obj == Py_None) {
+        quotechar = -1;
+    }
+    else if (quotechar_obj != NULL) {
+        if (!PyBytes_Check(quotechar_obj) ||
+            PyBytes_GET_SIZE(quotechar_obj) != 1) {
+            PyErr_SetString(PyExc_TypeError,
+                            "quotechar must be a byte string of length 1 or "
+                            "None");
+            goto error;
+        }
+        quotechar = (unsigned char)PyBytes_AS_STRING(quotechar_obj)[0];
+    }
+    if (column < 0) {
+        PyErr_SetString(PyExc_ValueError, "column must not be negative");
+        goto error;
+    }
+    if (skip_rows < 0) {
+        PyErr_SetString(PyExc_ValueError, "skip_rows must not be negative");
+        goto error;
+    }
+    if (delimiter == '\n' || delimiter == '\r' || delimiter == quotechar) {
+        PyErr_SetString(PyExc_ValueError,
+                        "delimiter must not be a line break or the quotechar");
+        goto error;
+    }
+
+    if (out == Py_None) {
+        values = PyList_New(0);
+        if (values == NULL)
+            goto error;
+    }
+    else {
+        if (_get_int64_buffer(out, offset, 0, &view) < 0)
+            goto error;
+        room = view.len / view.itemsize - offset;
+        errors = PyList_New(0);
+        if (errors == NULL)
+            goto error;
+    }
+
+    if (dedupe && _dedupe_init(&table, DEDUPE_INITIAL_SIZE) < 0)
+        goto error;
+
+    buf = buffer.buf;
+    while (pos < buffer.len) {
+        /* Blank lines aren't records */
+        if (buf[pos] == '\n' || buf[pos] == '\r') {
+            pos++;
+            continue;
+        }
+
+        /* Skipped records (e.g., a header row) are only scanned to find where
+         * they end, and don't count as records
+         */
+        if (skip_rows > 0) {
+            _find_field(buf, buffer.len, &pos, 0, delimiter, quotechar, &field,
+                        &field_len);
+            skip_rows--;
+            continue;
+        }
+
+        if (!_find_field(buf, buffer.len, &pos, column, delimiter, quotechar,
+                         &field, &field_len)) {
+            field = NULL;
+            field_len = 0;
+        }
+        first = record;
+        if (dedupe && field != NULL &&
+            (first = _dedupe_lookup(&table, field, field_len, record)) < 0)
+            goto error;
+
+        if (values != NULL) {
+            if (field == NULL) {
+                PyErr_Format(PyExc_ValueError, "Record %zd has no column %zd",
+                             record, column);
+                goto error;
+            }
+            if (first < record) {
+                obj = PyList_GET_ITEM(values, first);
+                Py_INCREF(obj);
+            }
+            else if ((obj = _parse(field, field_len, 1, 0, NULL)) == NULL) {
+                _add_record_to_error(record);
+                goto error;
+            }
+            rv = PyList_Append(values, obj);
+            Py_DECREF(obj);
+            if (rv < 0)
+                goto error;
+        }
+        else {
+            if (record >= room) {
+                PyErr_Format(PyExc_ValueError,
+                             "out has room for %zd values, but there are "
+                             "more records at offset %zd",
+                             room, offset);
+                goto error;
+            }
+            if (first < record)
+                rv = _reuse_int64((int64_t *)view.buf + offset, record, first,
+                                  errors);
+            else
+                rv = _parse_int64(field == NULL ? "" : field, field_len,
+                                  NULL, NULL,
+                                  (int64_t *)view.buf + offset + record,
+                                  errors, record);
+            if (rv < 0)
+                goto error;
+            parsed += rv;
+        }
+        record++;
+    }
+
+    if (values != NULL && dedupe) {
+        result = Py_BuildValue("(On)", values, table.count);
+    }
+    else if (values != NULL) {
+        result = values;
+        values = NULL;
+    }
+    else if (dedupe) {
+        result = Py_BuildValue("(nOn)", parsed, errors, table.count);
+    }
+    else {
+        result = Py_BuildValue("(nO)", parsed, errors);
+    }
+
+error:
+    _dedupe_free(&table);
+    Py_XDECREF(values);
+    Py_XDECREF(errors);
+    if (view.obj != NULL)
+        PyBuffer_Release(&view);
+    PyBuffer_Release(&buffer);
+    return result;
+}
+
+/* ------------------------------------------------------------- */
+/* Timestamp */
+
+#define US_PER_SECOND 1000000LL
+#define US_PER_DAY    (SECONDS_PER_DAY * US_PER_SECOND)
+
+/* `offset` value of naive timestamps */
+#define TIMESTAMP_NAIVE INT16_MIN
+
+/* A parsed timestamp, stored as the (UTC) microseconds since the epoch and
+ * the UTC offset in minutes. It is much smaller than a datetime (and its
+ * tzinfo), and only builds one when `to_datetime()` is called.
+ *
+ * Naive timestamps are stored as though they were in UTC. As with datetimes,
+ * naive and aware timestamps are never equal, can't be ordered, and can't be
+ * subtracted from each other.
+ */
+/* clang-format off */
+typedef struct {
+    PyObject_HEAD
+    int64_t epoch_us;
+    int16_t offset;
+} Timestamp;
+/* clang-format on */
+
+static PyTypeObject Timestamp_type;
+
+#define Timestamp_Check(obj) PyObject_TypeCheck(obj, &Timestamp_type)
+#define IS_NAIVE(timestamp)  ((timestamp)->offset == TIMESTAMP_NAIVE)
+
+static PyObject *
+_new_timestamp(int64_t epoch_us, int offset)
+{
+    Timestamp *self =
+        (Timestamp *)Timestamp_type.tp_alloc(&Timestamp_type, 0);
+
+    if (self != NULL) {
+        self->epoch_us = epoch_us;
+        self->offset = (int16_t)offset;
+    }
+    return (PyObject *)self;
+}
+
+static PyObject *
+Timestamp_to_datetime(Timestamp *self, PyObject *ignored)
+{
+    int offset = IS_NAIVE(self) ? 0 : self->offset;
+    long long local_us = self->epoch_us + offset * 60 * US_PER_SECOND;
+    long long seconds = _floor_div(local_us, US_PER_SECOND);
+    int ordinal, day_seconds, year, month, day;
+    PyObject *tzinfo = Py_None;
+    PyObject *obj;
+
+    if (_epoch_to_ordinal(seconds, &ordinal, &day_seconds) < 0)
+        return NULL;
+    ord_to_ymd(ordinal, &year, &month, &day);
+
+    if (!IS_NAIVE(self) && (tzinfo = _get_tzinfo(offset)) == NULL)
+        return NULL;
+
+    obj = PyDateTimeAPI->DateTime_FromDateAndTime(
+        year, month, day, day_seconds / 3600, day_seconds / 60 % 60,
+        day_seconds % 60, (int)(local_us - seconds * US_PER_SECOND), tzinfo,
+        PyDateTimeAPI->DateTimeType);
+
+    if (!IS_NAIVE(self))
+        Py_DECREF(tzinfo);
+    return obj;
+}
+
+static PyObject *
+Timestamp_timestamp(Timestamp *self, PyObject *ignored)
+{
+    return PyFloat_FromDouble((double)self->epoch_us / US_PER_SECOND);
+}
+
+static PyObject *
+Timestamp_get_epoch_microseconds(Timestamp *self, void *closure)
+{
+    return PyLong_FromLongLong(self->epoch_us);
+}
+
+static PyObject *
+Timestamp_get_utcoffset_minutes(Timestamp *self, void *closure)
+{
+    if (IS_NAIVE(self))
+        Py_RETURN_NONE;
+    return PyLong_FromLong(self->offset);
+}
+
+static PyObject *
+Timestamp_repr(Timestamp *self)
+{
+    PyObject *dt, *isoformat, *repr;
+
+    if ((dt = Timestamp_to_datetime(self, NULL)) == NULL)
+        return NULL;
+    isoformat = PyObject_CallMethod(dt, "isoformat", NULL);
+    Py_DECREF(dt);
+    if (isoformat == NULL)
+        return NULL;
+    repr = PyUnicode_FromFormat("ciso8601.Timestamp('%U')", isoformat);
+    Py_DECREF(isoformat);
+    return repr;
+}
+
+static Py_hash_t
+Timestamp_hash(Timestamp *self)
+{
+    /* Equal timestamps are the same instant, whatever their offsets */
+    Py_hash_t hash = (Py_hash_t)(self->epoch_us ^ (self->epoch_us >> 32));
+
+    return hash == -1 ? -2 : hash;
+}
+
+static PyObject *
+Timestamp_richcompare(PyObject *a, PyObject *b, int op)
+{
+    Timestamp *self, *other;
+
+    if (!Timestamp_Check(a) || !Timestamp_Check(b))
+        Py_RETURN_NOTIMPLEMENTED;
+    self = (Timestamp *)a;
+    other = (Timestamp *)b;
+
+    if (IS_NAIVE(self) != IS_NAIVE(other)) {
+        if (op == Py_EQ)
+            Py_RETURN_FALSE;
+        if (op == Py_NE)
+            Py_RETURN_TRUE;
+        PyErr_SetString(PyExc_TypeError,
+                        "can't compare offset-naive and offset-aware "
+                        "timestamps");
+        return NULL;
+    }
+    Py_RETURN_RICHCOMPARE(self->epoch_us, other->epoch_us, op);
+}
+
+static PyObject *
+Timestamp_subtract(PyObject *a, PyObject *b)
+{
+    Timestamp *self, *other;
+    long long delta_us, days;
+
+    if (!Timestamp_Check(a) || !Timestamp_Check(b))
+        Py_RETURN_NOTIMPLEMENTED;
+    self = (Timestamp *)a;
+    other = (Timestamp *)b;
+
+    if (IS_NAIVE(self) != IS_NAIVE(other)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "can't subtract offset-naive and offset-aware "
+                        "timestamps");
+        return NULL;
+    }
+
+    delta_us = self->epoch_us - other->epoch_us;
+    days = _floor_div(delta_us, US_PER_DAY);
+    delta_us -= days * US_PER_DAY;
+    return PyDelta_FromDSU((int)days, (int)(delta_us / US_PER_SECOND),
+                           (int)(delta_us % US_PER_SECOND));
+}
+
+static PyNumberMethods Timestamp_as_number = {
+    .nb_subtract = Timestamp_subtract,
+};
+
+static PyMethodDef Timestamp_methods[] = {
+    {"to_datetime", (PyCFunction)Timestamp_to_datetime, METH_NOARGS,
+     PyDoc_STR("Return the timestamp as a datetime.")},
+    {"timestamp", (PyCFunction)Timestamp_timestamp, METH_NOARGS,
+     PyDoc_STR("Return the seconds since the epoch as a float (naive "
+               "timestamps are treated as though they were in UTC).")},
+    {NULL}};
+
+static PyGetSetDef Timestamp_getset[] = {
+    {"epoch_microseconds", (getter)Timestamp_get_epoch_microseconds, NULL,
+     PyDoc_STR("Microseconds since the epoch (naive timestamps are treated "
+               "as though they were in UTC)."),
+     NULL},
+    {"utcoffset_minutes", (getter)Timestamp_get_utcoffset_minutes, NULL,
+     PyDoc_STR("UTC offset in minutes, or None for naive timestamps."), NULL},
+    {NULL}};
+
+/* clang-format off */
+static PyTypeObject Timestamp_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "ciso8601.Timestamp",
+    .tp_basicsize = sizeof(Timestamp),
+    .tp_repr = (reprfunc)Timestamp_repr,
+    .tp_as_number = &Timestamp_as_number,
+    .tp_hash = (hashfunc)Timestamp_hash,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "A parsed timestamp, stored as microseconds since the epoch "
+              "and a UTC offset. Returned by `parse_timestamp_obj`.",
+    .tp_richcompare = Timestamp_richcompare,
+    .tp_methods = Timestamp_methods,
+    .tp_getset = Timestamp_getset,
+};
+/* clang-format on */
+
+static PyObject *
+parse_timestamp_obj(PyObject *self, PyObject *dtstr)
+{
+    const char *str;
+    Py_ssize_t len;
+    ciso8601_result fields;
+    long long epoch;
+    int ordinal, seconds;
+
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return NULL;
+
+    if (_parse_fields(str, len, 1, 0, NULL, &fields) < 0 ||
+        _validate_fields(&fields) < 0)
+        return NULL;
+
+    /* Like a datetime, the local time must be representable (which 24:00 on
+     * 9999-12-31 isn't).
+     */
+    epoch = ciso8601_epoch_seconds(&fields);
+    if (_epoch_to_ordinal(epoch + fields.tzminute * 60, &ordinal, &seconds) <
+        0)
+        return NULL;
+
+    return _new_timestamp(epoch * US_PER_SECOND + fields.usecond,
+                          fields.has_tzinfo ? fields.tzminute
+                                            : TIMESTAMP_NAIVE);
+}
+
+/* ------------------------------------------------------------- */
+/* Sorting and searching */
+
+/* The sort key of a timestamp string: its epoch microseconds, with naive
+ * timestamps treated as though they were in UTC
+ */
+static int
+_timestamp_key(PyObject *dtstr, int64_t *key)
+{
+    const char *str;
+    Py_ssize_t len;
+    ciso8601_result fields;
+
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return -1;
+
+    if (_parse_fields(str, len, 1, 0, NULL, &fields) < 0 ||
+        _validate_fields(&fields) < 0)
+        return -1;
+
+    *key = ciso8601_epoch_seconds(&fields) * US_PER_SECOND + fields.usecond;
+    return 0;
+}
+
+/* Like `_timestamp_key`, but `instant` may also be a datetime or Timestamp */
+static int
+_instant_key(PyObject *instant, int64_t *key)
+{
+    ciso8601_result fields;
+    PyObject *offset;
+
+    if (Timestamp_Check(instant)) {
+        *key = ((Timestamp *)instant)->epoch_us;
+        return 0;
+    }
+    if (!PyDateTime_Check(instant))
+        return _timestamp_key(instant, key);
+
+    fields.year = PyDateTime_GET_YEAR(instant);
+    fields.month = PyDateTime_GET_MONTH(instant);
+    fields.day = PyDateTime_GET_DAY(instant);
+    fields.hour = PyDateTime_DATE_GET_HOUR(instant);
+    fields.minute = PyDateTime_DATE_GET_MINUTE(instant);
+    fields.second = PyDateTime_DATE_GET_SECOND(instant);
+    fields.time_is_midnight = 0;
+    fields.tzminute = 0;
+    *key = ciso8601_epoch_seconds(&fields) * US_PER_SECOND +
+           PyDateTime_DATE_GET_MICROSECOND(instant);
+
+    offset = PyObject_CallMethod(instant, "utcoffset", NULL);
+    if (offset == NULL)
+        return -1;
+    if (PyDelta_Check(offset))
+        *key -= (PyDateTime_DELTA_GET_DAYS(offset) * (int64_t)US_PER_DAY +
+                 PyDateTime_DELTA_GET_SECONDS(offset) * US_PER_SECOND +
+                 PyDateTime_DELTA_GET_MICROSECONDS(offset));
+    Py_DECREF(offset);
+    return 0;
+}
+
+typedef struct {
+    uint64_t key;
+    Py_ssize_t index;
+} SortItem;
+
+/* Sorts `items` by key, keeping items with equal keys in their original
+ * order. This is an LSD radix sort, a byte at a time, that skips the bytes
+ * that all of the keys share (e.g., the top bytes of timestamps from the same
+ * decades). `temp` must have room for `count` items.
+ */
+static void
+_radix_sort(SortItem *items, SortItem *temp, Py_ssize_t count)
+{
+    Py_ssize_t counts[256];
+    Py_ssize_t i, n, position;
+    SortItem *src = items, *dst = temp, *swap;
+    int shift;
+
+    if (count < 2)
+        return;
+
+    for (shift = 0; shift < 64; shift += 8) {
+        memset(counts, 0, sizeof(counts));
+        for (i = 0; i < count; i++) counts[(src[i].key >> shift) & 0xFF]++;
+        if (counts[(src[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        for (i = 0, position = 0; i < 256; i++) {
+            n = counts[i];
+            counts[i] = position;
+            position += n;
+        }
+        for (i = 0; i < count; i++)
+            dst[counts[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != items)
+        memcpy(items, src, count * sizeof(SortItem));
+}
+
+static PyObject *
+argsort_timestamps(PyObject *self, PyObject *dtstrs)
+{
+    PyObject *seq, *obj;
+    PyObject *result = NULL;
+    SortItem *items = NULL, *temp = NULL;
+    Py_ssize_t i, count;
+    int64_t key;
+
+    seq = PySequence_Fast(dtstrs, "argument must be iterable");
+    if (seq == NULL)
+        return NULL;
+
+    count = PySequence_Fast_GET_SIZE(seq);
+    items = PyMem_New(SortItem, count);
+    temp = PyMem_New(SortItem, count);
+    if (items == NULL || temp == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (_timestamp_key(PySequence_Fast_GET_ITEM(seq, i), &key) < 0)
+            goto error;
+        /* Flipping the sign bit makes the unsigned order the signed one */
+        items[i].key = (uint64_t)key ^ ((uint64_t)1 << 63);
+        items[i].index = i;
+    }
+
+    _radix_sort(items, temp, count);
+
+    result = PyList_New(count);
+    if (result == NULL)
+        goto error;
+    for (i = 0; i < count; i++) {
+        obj = PyLong_FromSsize_t(items[i].index);
+        if (obj == NULL) {
+            Py_CLEAR(result);
+            goto error;
+        }
+        PyList_SET_ITEM(result, i, obj);
+    }
+
+error:
+    PyMem_Free(items);
+    PyMem_Free(temp);
+    Py_DECREF(seq);
+    return result;
+}
+
+static PyObject *
+bisect_timestamps(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"sorted_seq", "instant", "lo",
+                             "hi",         "side",    NULL};
+    PyObject *seq, *instant, *item;
+    PyObject *hi_obj = Py_None;
+    const char *side = "left";
+    Py_ssize_t lo = 0, hi, mid;
+    int64_t target, key;
+    int right;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|nO$s:bisect_timestamps",
+                                     kwlist, &seq, &instant, &lo, &hi_obj,
+                                     &side))
+        return NULL;
+
+    if (strcmp(side, "left") == 0) {
+        right = 0;
+    }
+    else if (strcmp(side, "right") == 0) {
+        right = 1;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "side must be 'left' or 'right', not '%s'", side);
+        return NULL;
+    }
+    if (lo < 0) {
+        PyErr_SetString(PyExc_ValueError, "lo must be non-negative");
+        return NULL;
     }
-    else {
-        PyObject *unicode_str = PyUnicode_FromString(c);
-        PyObject *unicode_char = PyUnicode_Substring(unicode_str, 0, 1);
-        PyErr_Format(PyExc_ValueError,
-                     "Invalid character while parsing %s ('%U', Index: %zu)",
-                     field_name, unicode_char, index);
-        Py_DECREF(unicode_str);
-        Py_DECREF(unicode_char);
+    if (hi_obj == Py_None)
+        hi = PySequence_Size(seq);
+    else
+        hi = PyNumber_AsSsize_t(hi_obj, PyExc_OverflowError);
+    if (hi == -1 && PyErr_Occurred())
+        return NULL;
+
+    if (_instant_key(instant, &target) < 0)
+        return NULL;
+
+    /* Only the O(log n) probed strings are parsed */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if ((item = PySequence_GetItem(seq, mid)) == NULL)
+            return NULL;
+        if (_timestamp_key(item, &key) < 0) {
+            Py_DECREF(item);
+            return NULL;
+        }
+        Py_DECREF(item);
+
+        if (right ? key <= target : key < target)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
-    return NULL;
+    return PyLong_FromSsize_t(lo);
+}
+
+/* ------------------------------------------------------------- */
+/* Aggregates */
+
+static PyStructSequence_Field TimestampStats_fields[] = {
+    {"count", "The number of timestamps that were parsed"},
+    {"errors", "The number of timestamps that failed to parse"},
+    {"min", "The earliest timestamp, as a Timestamp (or None)"},
+    {"max", "The latest timestamp, as a Timestamp (or None)"},
+    {"monotonic", "Whether the timestamps never go back in time"},
+    {"histogram",
+     "The number of timestamps in each bucket, keyed by the start of the "
+     "bucket in seconds since the epoch (or None)"},
+    {NULL}};
+
+static PyStructSequence_Desc TimestampStats_desc = {
+    "ciso8601.TimestampStats",
+    "The aggregates of timestamps, as returned by `timestamp_stats`.",
+    TimestampStats_fields,
+    6,
+};
+
+static PyTypeObject TimestampStats_type;
+
+/* The running aggregates of `timestamp_stats`. Keys are epoch microseconds,
+ * with naive timestamps treated as though they were in UTC.
+ *
+ * Consecutive timestamps in the same bucket are counted in `run` and only
+ * added to `histogram` when the bucket changes, so that (mostly) sorted input
+ * doesn't touch the dict for every timestamp.
+ */
+typedef struct {
+    Py_ssize_t count, errors;
+    int64_t min, max, last;
+    int min_offset, max_offset;
+    int monotonic;
+    const BucketUnit *unit;
+    PyObject *histogram;
+    long long run_bucket;
+    Py_ssize_t run;
+} TimestampAggregates;
+
+static int
+_flush_bucket_run(TimestampAggregates *stats)
+{
+    PyObject *key, *value;
+    Py_ssize_t n = stats->run;
+    int rv = -1;
+
+    if (n == 0)
+        return 0;
+    stats->run = 0;
+
+    if ((key = PyLong_FromLongLong(stats->run_bucket)) == NULL)
+        return -1;
+    value = PyDict_GetItemWithError(stats->histogram, key);
+    if (value != NULL) {
+        n += PyLong_AsSsize_t(value);
+        if (n == -1 && PyErr_Occurred())
+            goto error;
+    }
+    else if (PyErr_Occurred()) {
+        goto error;
+    }
+    if ((value = PyLong_FromSsize_t(n)) == NULL)
+        goto error;
+    rv = PyDict_SetItem(stats->histogram, key, value);
+    Py_DECREF(value);
+
+error:
+    Py_DECREF(key);
+    return rv;
 }
 
-#define IS_CALENDAR_DATE_SEPARATOR (*c == '-')
-#define IS_ISOCALENDAR_SEPARATOR   (*c == 'W')
-#define IS_DATE_AND_TIME_SEPARATOR (*c == 'T' || *c == ' ' || *c == 't')
-#define IS_TIME_SEPARATOR          (*c == ':')
-#define IS_TIME_ZONE_SEPARATOR \
-    (*c == 'Z' || *c == '-' || *c == '+' || *c == 'z')
-#define IS_FRACTIONAL_SEPARATOR (*c == '.' || (*c == ',' && !rfc3339_only))
+/* Adds `str` to the aggregates. Timestamps that fail to parse (or whose
+ * bucket or local time can't be represented) are only counted as errors.
+ */
+static int
+_add_to_timestamp_stats(TimestampAggregates *stats, const char *str,
+                        Py_ssize_t len)
+{
+    ciso8601_result fields;
+    long long epoch, bucket, days;
+    int64_t key;
+    int offset;
+
+    if (ciso8601_parse(str, (size_t)len, 0, &fields) != CISO8601_OK ||
+        ciso8601_validate(&fields) != CISO8601_OK)
+        goto invalid;
+
+    /* Like `parse_timestamp_obj`, the local time must be representable */
+    epoch = ciso8601_epoch_seconds(&fields);
+    days = _floor_div(epoch + fields.tzminute * 60, SECONDS_PER_DAY);
+    if (days + EPOCH_ORDINAL < 1 || days + EPOCH_ORDINAL > MAX_ORDINAL)
+        goto invalid;
+
+    if (stats->unit != NULL) {
+        if (_bucket_start(epoch, stats->unit, &bucket) < 0) {
+            if (!PyErr_ExceptionMatches(PyExc_OverflowError))
+                return -1;
+            PyErr_Clear();
+            goto invalid;
+        }
+        if (stats->run > 0 && bucket != stats->run_bucket &&
+            _flush_bucket_run(stats) < 0)
+            return -1;
+        stats->run_bucket = bucket;
+        stats->run++;
+    }
+
+    key = epoch * US_PER_SECOND + fields.usecond;
+    offset = fields.has_tzinfo ? fields.tzminute : TIMESTAMP_NAIVE;
+    if (stats->count == 0 || key < stats->min) {
+        stats->min = key;
+        stats->min_offset = offset;
+    }
+    if (stats->count == 0 || key > stats->max) {
+        stats->max = key;
+        stats->max_offset = offset;
+    }
+    if (stats->count > 0 && key < stats->last)
+        stats->monotonic = 0;
+    stats->last = key;
+    stats->count++;
+    return 0;
+
+invalid:
+    stats->errors++;
+    return 0;
+}
 
 static PyObject *
-_parse(PyObject *self, PyObject *dtstr, int parse_any_tzinfo, int rfc3339_only)
+timestamp_stats(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    PyObject *obj;
-    PyObject *tzinfo = Py_None;
-    Py_ssize_t len;
+    static char *kwlist[] = {"timestamps", "bucket", NULL};
+    PyObject *input, *bucket_obj = Py_None;
+    PyObject *iterator = NULL, *item, *min = NULL, *max = NULL;
+    PyObject *result = NULL;
+    TimestampAggregates stats = {0};
+    BucketUnit unit;
+    Py_buffer buffer;
+    const char *buf, *str, *newline;
+    Py_ssize_t len, pos = 0;
+    int rv;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O:timestamp_stats",
+                                     kwlist, &input, &bucket_obj))
+        return NULL;
+    buffer.obj = NULL;
+    stats.monotonic = 1;
+
+    if (bucket_obj != Py_None) {
+        if (_parse_bucket_unit(bucket_obj, &unit) < 0)
+            return NULL;
+        stats.unit = &unit;
+        if ((stats.histogram = PyDict_New()) == NULL)
+            return NULL;
+    }
+
+    if (PyUnicode_Check(input)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "timestamps must be an iterable of strings or a "
+                        "bytes-like object, not str");
+        goto error;
+    }
+    else if (PyObject_CheckBuffer(input)) {
+        /* One timestamp per line, skipping blank lines */
+        if (PyObject_GetBuffer(input, &buffer, PyBUF_SIMPLE) < 0)
+            goto error;
+        buf = buffer.buf;
+        while (pos < buffer.len) {
+            newline = memchr(buf + pos, '\n', buffer.len - pos);
+            len = (newline != NULL ? newline - buf : buffer.len) - pos;
+            str = buf + pos;
+            pos += len + 1;
+            if (len > 0 && str[len - 1] == '\r')
+                len--;
+            if (len > 0 && _add_to_timestamp_stats(&stats, str, len) < 0)
+                goto error;
+        }
+    }
+    else {
+        if ((iterator = PyObject_GetIter(input)) == NULL)
+            goto error;
+        while ((item = PyIter_Next(iterator)) != NULL) {
+            str = _as_utf8(item, &len);
+            rv = str == NULL ? -1 : _add_to_timestamp_stats(&stats, str, len);
+            Py_DECREF(item);
+            if (rv < 0)
+                goto error;
+        }
+        if (PyErr_Occurred())
+            goto error;
+    }
+
+    if (stats.histogram != NULL && _flush_bucket_run(&stats) < 0)
+        goto error;
+
+    if (stats.count > 0) {
+        if ((min = _new_timestamp(stats.min, stats.min_offset)) == NULL ||
+            (max = _new_timestamp(stats.max, stats.max_offset)) == NULL)
+            goto error;
+    }
+    else {
+        Py_INCREF(Py_None);
+        min = Py_None;
+        Py_INCREF(Py_None);
+        max = Py_None;
+    }
+    if (stats.histogram == NULL) {
+        Py_INCREF(Py_None);
+        stats.histogram = Py_None;
+    }
+
+    if ((result = PyStructSequence_New(&TimestampStats_type)) == NULL)
+        goto error;
+    PyStructSequence_SET_ITEM(result, 2, min);
+    PyStructSequence_SET_ITEM(result, 3, max);
+    PyStructSequence_SET_ITEM(result, 4, PyBool_FromLong(stats.monotonic));
+    PyStructSequence_SET_ITEM(result, 5, stats.histogram);
+    min = max = stats.histogram = NULL;
+    if ((item = PyLong_FromSsize_t(stats.count)) == NULL) {
+        Py_CLEAR(result);
+        goto error;
+    }
+    PyStructSequence_SET_ITEM(result, 0, item);
+    if ((item = PyLong_FromSsize_t(stats.errors)) == NULL) {
+        Py_CLEAR(result);
+        goto error;
+    }
+    PyStructSequence_SET_ITEM(result, 1, item);
+
+error:
+    Py_XDECREF(min);
+    Py_XDECREF(max);
+    Py_XDECREF(stats.histogram);
+    Py_XDECREF(iterator);
+    if (buffer.obj != NULL)
+        PyBuffer_Release(&buffer);
+    return result;
+}
+
+/* ------------------------------------------------------------- */
+/* Durations and intervals */
+
+/* Length of each duration component, in seconds. The lengths of years and
+ * months are their averages in the Gregorian calendar, which are only used
+ * with `approximate=True`.
+ */
+static const long long duration_seconds[CISO8601_DURATION_COMPONENTS] = {
+    31556952, 2629746, 7 * SECONDS_PER_DAY, SECONDS_PER_DAY, 3600, 60, 1};
+
+/* Raises the ValueError describing why a duration failed to parse, where
+ * `offset` is the index of the duration within `str`.
+ */
+static int
+_raise_duration_error(const char *str, size_t len, size_t offset,
+                      const ciso8601_duration *duration)
+{
+    ciso8601_result result;
+
+    memset(&result, 0, sizeof(result));
+    result.error = duration->error;
+    result.error_position = offset + duration->error_position;
+    result.error_field = duration->error_field;
+    result.error_value = duration->error_value;
+    return _raise_parse_error(str, (Py_ssize_t)len, &result);
+}
+
+static int
+_parse_duration_at(const char *str, size_t len, size_t offset,
+                   size_t duration_len, ciso8601_duration *duration)
+{
+    if (ciso8601_parse_duration(str + offset, duration_len, duration) !=
+        CISO8601_OK)
+        return _raise_duration_error(str, len, offset, duration);
+    return 0;
+}
 
+/* The timedelta of the components of `duration` from `first` onwards */
+static PyObject *
+_timedelta_from_duration(const ciso8601_duration *duration,
+                         ciso8601_duration_component first)
+{
+    long long seconds = 0, fraction_ns = 0, days, useconds;
     int i;
-    const char *str;
-    const char *c;
-    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0,
-        usecond = 0;
-    int iso_week = 0, iso_day = 0;
-    int ordinal_day = 0;
-    int time_is_midnight = 0;
-    int tzhour = 0, tzminute = 0, tzsign = 0;
-#if CISO8601_CACHING_ENABLED
-    int tz_index = 0;
-#endif
-    PyObject *delta;
-    PyObject *temp;
-    int extended_date_format = 0;
 
-    if (!PyUnicode_Check(dtstr)) {
-        PyErr_SetString(PyExc_TypeError, "argument must be str");
+    for (i = first; i < CISO8601_DURATION_COMPONENTS; i++)
+        seconds += duration->values[i] * duration_seconds[i];
+
+    /* Billionths of the component, times its length in seconds */
+    if (duration->fraction_component >= first)
+        fraction_ns = (long long)duration->fraction *
+                      duration_seconds[duration->fraction_component];
+    seconds += fraction_ns / 1000000000;
+    useconds = fraction_ns % 1000000000 / 1000;
+
+    days = seconds / SECONDS_PER_DAY;
+    seconds %= SECONDS_PER_DAY;
+    if (days > 999999999) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "duration is too large for a timedelta");
         return NULL;
     }
 
-    str = c = PyUnicode_AsUTF8AndSize(dtstr, &len);
+    if (duration->negative)
+        return PyDelta_FromDSU(-(int)days, -(int)seconds, -(int)useconds);
+    return PyDelta_FromDSU((int)days, (int)seconds, (int)useconds);
+}
 
-    /* Year */
-    PARSE_INTEGER(year, 4, "year")
+static int
+_has_calendar_components(const ciso8601_duration *duration)
+{
+    return duration->values[CISO8601_DURATION_YEARS] != 0 ||
+           duration->values[CISO8601_DURATION_MONTHS] != 0 ||
+           (duration->fraction != 0 &&
+            duration->fraction_component <= CISO8601_DURATION_MONTHS);
+}
 
-    /* Year validation is handled by Python 3.6+ datetime's C API constructor.
-     * See
-     * https://github.com/python/cpython/commit/b67f0967386a9c9041166d2bbe0a421bd81e10bc
-     */
+static PyObject *
+parse_duration(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"duration_string", "approximate", NULL};
+    PyObject *dtstr;
+    int approximate = 0;
+    const char *str;
+    Py_ssize_t len;
+    ciso8601_duration duration;
 
-    if (IS_CALENDAR_DATE_SEPARATOR) {
-        c++;
-        extended_date_format = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|p:parse_duration",
+                                     kwlist, &dtstr, &approximate))
+        return NULL;
 
-        if (IS_ISOCALENDAR_SEPARATOR) { /* Separated ISO Calendar week and day
-                                           (i.e., Www-D) */
-            c++;
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return NULL;
 
-            if (rfc3339_only) {
-                PyErr_SetString(PyExc_ValueError,
-                                "Datetime string not in RFC 3339 format.");
-                return NULL;
-            }
+    if (_parse_duration_at(str, len, 0, len, &duration) < 0)
+        return NULL;
 
-            PARSE_INTEGER(iso_week, 2, "iso_week")
+    if (!approximate && _has_calendar_components(&duration)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Years and months don't have a fixed length, so "
+                        "they can't be converted to a timedelta (use "
+                        "`approximate=True` to use their average lengths)");
+        return NULL;
+    }
 
-            if (*c != '\0' && !IS_DATE_AND_TIME_SEPARATOR) { /* Optional Day */
-                PARSE_SEPARATOR(IS_CALENDAR_DATE_SEPARATOR,
-                                "date separator ('-')")
-                PARSE_INTEGER(iso_day, 1, "iso_day")
-            }
-            else {
-                iso_day = 1;
-            }
+    return _timedelta_from_duration(&duration, CISO8601_DURATION_YEARS);
+}
 
-            int rv = iso_to_ymd(year, iso_week, iso_day, &year, &month, &day);
-            if (rv) {
-                PyErr_Format(PyExc_ValueError, "Invalid ISO Calendar date");
-                return NULL;
-            }
-        }
-        else { /* Separated month and may (i.e., MM-DD) or
-                  ordinal date (i.e., DDD) */
-            /* For sake of simplicity, we'll assume that it is a month
-             * If we find out later that it's an ordinal day, then we'll adjust
-             */
-            PARSE_INTEGER(month, 2, "month")
+/* Parses the datetime at [offset, offset + part_len) of `str`. Error indices
+ * are relative to the whole of `str`.
+ */
+static int
+_parse_interval_datetime(const char *str, size_t len, size_t offset,
+                         size_t part_len, ciso8601_result *fields)
+{
+    if (ciso8601_parse(str + offset, part_len, 0, fields) != CISO8601_OK) {
+        fields->error_position += offset;
+        return _raise_parse_error(str, (Py_ssize_t)len, fields);
+    }
+    return _validate_fields(fields);
+}
 
-            if (*c != '\0' && !IS_DATE_AND_TIME_SEPARATOR) {
-                if (IS_CALENDAR_DATE_SEPARATOR) { /* Optional day */
-                    c++;
-                    PARSE_INTEGER(day, 2, "day")
-                }
-                else { /* Ordinal day */
-                    PARSE_INTEGER(ordinal_day, 1, "ordinal day")
-                    ordinal_day = (month * 10) + ordinal_day;
-
-                    int rv =
-                        ordinal_to_ymd(year, ordinal_day, &year, &month, &day);
-                    if (rv) {
-                        PyErr_Format(
-                            PyExc_ValueError,
-                            "Invalid ordinal day: %d is %s for year %d",
-                            ordinal_day, rv == -1 ? "too small" : "too large",
-                            year);
-                        return NULL;
-                    }
-                }
-            }
-            else if (rfc3339_only) {
-                PyErr_SetString(PyExc_ValueError,
-                                "Datetime string not in RFC 3339 format.");
-                return NULL;
-            }
-            else {
-                day = 1;
-            }
-        }
+/* Adds the duration's years and months (times `sign`) to the date of
+ * `fields`, clamping the day to the end of the resulting month (i.e.,
+ * 2020-01-31 plus one month is 2020-02-29). Then adds the rest of the
+ * duration (times `sign`), and returns the result as a datetime.
+ */
+static PyObject *
+_add_duration(ciso8601_result fields, const ciso8601_duration *duration,
+              int sign)
+{
+    long long months;
+    int days_in_target_month;
+    PyObject *dt, *delta, *result;
+
+    if (duration->fraction != 0 &&
+        duration->fraction_component <= CISO8601_DURATION_MONTHS) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Fractional years and months are not supported in "
+                        "intervals");
+        return NULL;
+    }
+
+    months = duration->values[CISO8601_DURATION_YEARS] * 12 +
+             duration->values[CISO8601_DURATION_MONTHS];
+    if (duration->negative)
+        months = -months;
+    months = fields.year * 12LL + (fields.month - 1) + sign * months;
+    if (months < 12 || months >= 10000 * 12) {
+        PyErr_SetString(PyExc_OverflowError, "date value out of range");
+        return NULL;
+    }
+    fields.year = (int)(months / 12);
+    fields.month = (int)(months % 12) + 1;
+    days_in_target_month = days_in_month(fields.year, fields.month);
+    if (fields.day > days_in_target_month)
+        fields.day = days_in_target_month;
+
+    if ((dt = _datetime_from_fields(&fields)) == NULL)
+        return NULL;
+    delta = _timedelta_from_duration(duration, CISO8601_DURATION_WEEKS);
+    if (delta == NULL) {
+        Py_DECREF(dt);
+        return NULL;
     }
-    else if (rfc3339_only) {
+    result = sign > 0 ? PyNumber_Add(dt, delta) : PyNumber_Subtract(dt, delta);
+    Py_DECREF(dt);
+    Py_DECREF(delta);
+    return result;
+}
+
+static PyObject *
+parse_interval(PyObject *self, PyObject *dtstr)
+{
+    const char *str, *slash;
+    Py_ssize_t len;
+    size_t start_len, end_offset, end_len;
+    int start_is_duration, end_is_duration;
+    ciso8601_result fields;
+    ciso8601_duration duration;
+    PyObject *start = NULL, *end = NULL, *result;
+
+    if ((str = _as_utf8(dtstr, &len)) == NULL)
+        return NULL;
+
+    if ((slash = memchr(str, '/', len)) == NULL) {
         PyErr_SetString(PyExc_ValueError,
-                        "Datetime string not in RFC 3339 format.");
+                        "Interval must be two parts separated by '/'");
         return NULL;
     }
-    else {
-        if (IS_ISOCALENDAR_SEPARATOR) { /* Non-separated ISO Calendar week and
-                                           day (i.e., WwwD) */
-            c++;
+    start_len = slash - str;
+    end_offset = start_len + 1;
+    end_len = len - end_offset;
+    start_is_duration = start_len > 0 && str[0] == 'P';
+    end_is_duration = end_len > 0 && str[end_offset] == 'P';
 
-            PARSE_INTEGER(iso_week, 2, "iso_week")
+    if (start_is_duration && end_is_duration) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Interval can't be made of two durations");
+        return NULL;
+    }
 
-            if (*c != '\0' && !IS_DATE_AND_TIME_SEPARATOR) { /* Optional Day */
-                PARSE_INTEGER(iso_day, 1, "iso_day")
-            }
-            else {
-                iso_day = 1;
-            }
+    if (start_is_duration) { /* duration/end */
+        if (_parse_duration_at(str, len, 0, start_len, &duration) < 0 ||
+            _parse_interval_datetime(str, len, end_offset, end_len, &fields) <
+                0)
+            return NULL;
+        if ((end = _datetime_from_fields(&fields)) == NULL)
+            return NULL;
+        start = _add_duration(fields, &duration, -1);
+    }
+    else {
+        if (_parse_interval_datetime(str, len, 0, start_len, &fields) < 0 ||
+            (start = _datetime_from_fields(&fields)) == NULL)
+            return NULL;
 
-            int rv = iso_to_ymd(year, iso_week, iso_day, &year, &month, &day);
-            if (rv) {
-                PyErr_Format(PyExc_ValueError, "Invalid ISO Calendar date");
-                return NULL;
-            }
+        if (end_is_duration) { /* start/duration */
+            if (_parse_duration_at(str, len, end_offset, end_len,
+                                   &duration) == 0)
+                end = _add_duration(fields, &duration, 1);
         }
-        else { /* Non-separated Month and Day (i.e., MMDD) or
-                  ordinal date (i.e., DDD)*/
-            /* For sake of simplicity, we'll assume that it is a month
-             * If we find out later that it's an ordinal day, then we'll adjust
-             */
-            PARSE_INTEGER(month, 2, "month")
-
-            PARSE_INTEGER(ordinal_day, 1, "ordinal day")
-
-            if (*c == '\0' || IS_DATE_AND_TIME_SEPARATOR) { /* Ordinal day */
-                ordinal_day = (month * 10) + ordinal_day;
-                int rv =
-                    ordinal_to_ymd(year, ordinal_day, &year, &month, &day);
-                if (rv) {
-                    PyErr_Format(PyExc_ValueError,
-                                 "Invalid ordinal day: %d is %s for year %d",
-                                 ordinal_day,
-                                 rv == -1 ? "too small" : "too large", year);
-                    return NULL;
-                }
-            }
-            else { /* Day */
-                /* Note that YYYYMM is not a valid timestamp. If the calendar
-                 * date is not separated, a day is required (i.e., YYMMDD)
-                 */
-                PARSE_INTEGER(day, 1, "day")
-                day = (ordinal_day * 10) + day;
-            }
+        else if (_parse_interval_datetime(str, len, end_offset, end_len,
+                                          &fields) == 0) { /* start/end */
+            end = _datetime_from_fields(&fields);
         }
     }
 
-    /* Validation of date fields is handled by Python 3.6+ datetime's C API
-     * constructor. See https://github.com/closeio/ciso8601/pull/30 and
-     * https://github.com/python/cpython/commit/b67f0967386a9c9041166d2bbe0a421bd81e10bc
-     */
+    if (start == NULL || end == NULL) {
+        Py_XDECREF(start);
+        Py_XDECREF(end);
+        return NULL;
+    }
+    result = PyTuple_Pack(2, start, end);
+    Py_DECREF(start);
+    Py_DECREF(end);
+    return result;
+}
 
-    if (*c != '\0') {
-        /* Date and time separator */
-        PARSE_SEPARATOR(IS_DATE_AND_TIME_SEPARATOR,
-                        "date and time separator (i.e., 'T', 't', or ' ')")
+/* ------------------------------------------------------------- */
+/* C API (see ciso8601/ciso8601.h) */
 
-        /* Hour */
-        PARSE_INTEGER(hour, 2, "hour")
+/* Parses `str` with the grammar selected by the C API `flags` */
+static int
+_capi_parse_fields(const char *str, size_t len, int flags,
+                   ciso8601_result *fields)
+{
+    int rfc2822_flags = flags & CISO8601_NAIVE ? CISO8601_FLAG_NAIVE : 0;
+
+    if (flags & CISO8601_HTTP_DATE)
+        return _parse_rfc2822_fields(str, (Py_ssize_t)len,
+                                     rfc2822_flags | CISO8601_FLAG_HTTP_DATE,
+                                     fields);
+    if (flags & CISO8601_RFC2822)
+        return _parse_rfc2822_fields(str, (Py_ssize_t)len, rfc2822_flags,
+                                     fields);
+    return _parse_fields(str, (Py_ssize_t)len, !(flags & CISO8601_NAIVE),
+                         flags & CISO8601_RFC3339, NULL, fields);
+}
 
-        if (*c != '\0' &&
-            !IS_TIME_ZONE_SEPARATOR) { /* Optional minute and second */
+static PyObject *
+capi_parse_datetime(const char *str, size_t len, int flags)
+{
+    ciso8601_result fields;
 
-            if (IS_TIME_SEPARATOR) { /* Separated Minute and Second
-                                      *  (i.e., mm:ss)
-                                      */
-                c++;
+    if (_capi_parse_fields(str, len, flags, &fields) < 0)
+        return NULL;
 
-                /* Minute */
-                PARSE_INTEGER(minute, 2, "minute")
+    return _datetime_from_fields(&fields);
+}
 
-                if (*c != '\0' &&
-                    !IS_TIME_ZONE_SEPARATOR) { /* Optional Second */
-                    PARSE_SEPARATOR(IS_TIME_SEPARATOR, "time separator (':')")
+static int
+_capi_parse_valid_fields(const char *str, size_t len, int flags,
+                         ciso8601_result *fields)
+{
+    if (_capi_parse_fields(str, len, flags, fields) < 0)
+        return -1;
 
-                    /* Second */
-                    PARSE_INTEGER(second, 2, "second")
+    return _validate_fields(fields);
+}
 
-                    /* Optional Fractional Second */
-                    if (IS_FRACTIONAL_SEPARATOR) {
-                        c++;
-                        PARSE_FRACTIONAL_SECOND()
-                    }
-                }
-                else if (rfc3339_only) {
-                    PyErr_SetString(PyExc_ValueError,
-                                    "RFC 3339 requires the second to be "
-                                    "specified.");
-                    return NULL;
-                }
+static int
+capi_parse_epoch(const char *str, size_t len, int flags, int64_t *epoch_us)
+{
+    ciso8601_result fields;
 
-                if (!extended_date_format) {
-                    PyErr_SetString(
-                        PyExc_ValueError,
-                        "Cannot combine \"basic\" date format with"
-                        " \"extended\" time format (Should be either "
-                        "`YYYY-MM-DDThh:mm:ss` or `YYYYMMDDThhmmss`).");
-                    return NULL;
-                }
-            }
-            else if (rfc3339_only) {
-                PyErr_SetString(PyExc_ValueError,
-                                "Colons separating time components are "
-                                "mandatory in RFC 3339.");
-                return NULL;
-            }
-            else { /* Non-separated Minute and Second (i.e., mmss) */
-                /* Minute */
-                PARSE_INTEGER(minute, 2, "minute")
-                if (*c != '\0' &&
-                    !IS_TIME_ZONE_SEPARATOR) { /* Optional Second */
-                    /* Second */
-                    PARSE_INTEGER(second, 2, "second")
-
-                    /* Optional Fractional Second */
-                    if (IS_FRACTIONAL_SEPARATOR) {
-                        c++;
-                        PARSE_FRACTIONAL_SECOND()
-                    }
-                }
+    if (_capi_parse_valid_fields(str, len, flags, &fields) < 0)
+        return -1;
 
-                if (extended_date_format) {
-                    PyErr_SetString(
-                        PyExc_ValueError,
-                        "Cannot combine \"extended\" date format with"
-                        " \"basic\" time format (Should be either "
-                        "`YYYY-MM-DDThh:mm:ss` or `YYYYMMDDThhmmss`).");
-                    return NULL;
-                }
-            }
-        }
-        else if (rfc3339_only) {
-            PyErr_SetString(PyExc_ValueError,
-                            "Minute and second are mandatory in RFC 3339");
-            return NULL;
-        }
+    *epoch_us = ciso8601_epoch_seconds(&fields) * 1000000 + fields.usecond;
+    return 0;
+}
 
-        if (hour == 24 && minute == 0 && second == 0 && usecond == 0) {
-            /* Special case of 24:00:00, that is allowed in ISO 8601. It is
-             * equivalent to 00:00:00 the following day
-             */
-            if (rfc3339_only) {
-                PyErr_SetString(PyExc_ValueError,
-                                "An hour value of 24, while sometimes legal "
-                                "in ISO 8601, is explicitly forbidden by RFC "
-                                "3339.");
-                return NULL;
-            }
-            hour = 0, minute = 0, second = 0, usecond = 0;
-            time_is_midnight = 1;
+static int
+capi_parse_fields(const char *str, size_t len, int flags,
+                  CISO8601_Fields *result)
+{
+    ciso8601_result fields;
+    int ordinal;
+
+    if (_capi_parse_valid_fields(str, len, flags, &fields) < 0)
+        return -1;
+
+    if (fields.time_is_midnight) {
+        ordinal = ymd_to_ord(fields.year, fields.month, fields.day) + 1;
+        if (ordinal > MAX_ORDINAL) {
+            PyErr_SetString(PyExc_OverflowError, "date value out of range");
+            return -1;
         }
+        ord_to_ymd(ordinal, &fields.year, &fields.month, &fields.day);
+    }
 
-        /* Validation of hour/minute/second is handled by Python 3.6+
-         * datetime's constructor.
-         */
+    result->year = fields.year;
+    result->month = fields.month;
+    result->day = fields.day;
+    result->hour = fields.hour;
+    result->minute = fields.minute;
+    result->second = fields.second;
+    result->usecond = fields.usecond;
+    result->has_tzinfo = fields.has_tzinfo;
+    result->tzminute = fields.tzminute;
+    return 0;
+}
 
-        /* Optional tzinfo */
-        if (IS_TIME_ZONE_SEPARATOR) {
-            if (*c == '+') {
-                tzsign = 1;
-            }
-            else if (*c == '-') {
-                tzsign = -1;
-            }
-            c++;
+static CISO8601_CAPI capi = {
+    CISO8601_CAPI_VERSION,
+    capi_parse_datetime,
+    capi_parse_epoch,
+    capi_parse_fields,
+};
 
-            if (tzsign != 0) {
-                /* tz hour */
-                PARSE_INTEGER(tzhour, 2, "tz hour")
+/* ------------------------------------------------------------- */
+/* Counters (see stats.h) */
 
-                if (IS_TIME_SEPARATOR) { /* Optional separator */
-                    c++;
-                    /* tz minute */
-                    PARSE_INTEGER(tzminute, 2, "tz minute")
-                }
-                else if (rfc3339_only) {
-                    PyErr_SetString(PyExc_ValueError,
-                                    "Separator between hour and minute in UTC "
-                                    "offset is mandatory in RFC 3339");
-                    return NULL;
-                }
-                else if (*c != '\0') { /* Optional tz minute */
-                    PARSE_INTEGER(tzminute, 2, "tz minute")
-                }
-            }
+#if CISO8601_STATS_ENABLED
+/* Adds `key: value` to `dict`, consuming the reference to `value` */
+static int
+_set_item(PyObject *dict, PyObject *key, PyObject *value)
+{
+    int rv;
 
-            /* It's not entirely clear whether this validation check is
-             * necessary under ISO 8601. For now, we will err on the side of
-             * caution and prevent suspected invalid timestamps. If we need to
-             * loosen this restriction later, we can.
-             */
-            if (tzminute > 59) {
-                PyErr_SetString(PyExc_ValueError, "tzminute must be in 0..59");
-                return NULL;
-            }
+    if (key == NULL || value == NULL) {
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        return -1;
+    }
+    rv = PyDict_SetItem(dict, key, value);
+    Py_DECREF(key);
+    Py_DECREF(value);
+    return rv;
+}
 
-            if (parse_any_tzinfo) {
-                tzminute += 60 * tzhour;
-                tzminute *= tzsign;
+#define SET_COUNT(dict, name, counter)                                  \
+    if (_set_item(dict, PyUnicode_FromString(name),                     \
+                  PyLong_FromUnsignedLongLong(STATS_LOAD(counter))) < 0) \
+        goto error;
 
-                if (tzminute == 0) {
-                    tzinfo = utc;
-                }
-                else if (abs(tzminute) >= 1440) {
-                    delta = PyDelta_FromDSU(0, tzminute * 60, 0);
-                    PyErr_Format(PyExc_ValueError,
-                                 "offset must be a timedelta"
-                                 " strictly between -timedelta(hours=24) and"
-                                 " timedelta(hours=24),"
-                                 " not %R.",
-                                 delta);
-                    Py_DECREF(delta);
-                    return NULL;
-                }
-                else {
-#if CISO8601_CACHING_ENABLED
-                    tz_index = tzminute + 1439;
-                    if ((tzinfo = tz_cache[tz_index]) == NULL) {
-                        tzinfo = new_fixed_offset(60 * tzminute);
-
-                        if (tzinfo == NULL) /* i.e., PyErr_Occurred() */
-                            return NULL;
-                        tz_cache[tz_index] = tzinfo;
-                    }
-#else
-                    tzinfo = new_fixed_offset(60 * tzminute);
-                    if (tzinfo == NULL) /* i.e., PyErr_Occurred() */
-                        return NULL;
-#endif
-                }
-            }
-        }
-        else if (rfc3339_only) {
-            PyErr_SetString(PyExc_ValueError,
-                            "UTC offset is mandatory in RFC 3339 format.");
+/* Only the non-zero counts of `counters`, keyed by `names` (or by the index
+ * if `names` is NULL).
+ */
+static PyObject *
+_nonzero_counts(uint64_t *counters, size_t count, const char *const *names)
+{
+    PyObject *dict = PyDict_New();
+    uint64_t value;
+    size_t i;
+
+    if (dict == NULL)
+        return NULL;
+    for (i = 0; i < count; i++) {
+        if ((value = STATS_LOAD(counters[i])) == 0)
+            continue;
+        if (_set_item(dict,
+                      names ? PyUnicode_FromString(names[i])
+                            : PyLong_FromSize_t(i),
+                      PyLong_FromUnsignedLongLong(value)) < 0) {
+            Py_DECREF(dict);
             return NULL;
         }
     }
-    else if (rfc3339_only) {
-        PyErr_SetString(PyExc_ValueError,
-                        "Time is mandatory in RFC 3339 format.");
-        return NULL;
-    }
-
-    /* Make sure that there is no more to parse. */
-    if (*c != '\0') {
-        PyErr_Format(PyExc_ValueError, "unconverted data remains: '%s'", c);
-#if !CISO8601_CACHING_ENABLED
-        if (tzinfo != Py_None && tzinfo != utc)
-            Py_DECREF(tzinfo);
+    return dict;
+}
 #endif
-        return NULL;
-    }
 
-    obj = PyDateTimeAPI->DateTime_FromDateAndTime(
-        year, month, day, hour, minute, second, usecond, tzinfo,
-        PyDateTimeAPI->DateTimeType);
+static PyObject *
+get_stats(PyObject *self, PyObject *ignored)
+{
+#if CISO8601_STATS_ENABLED
+    PyObject *result = PyDict_New();
+    PyObject *formats = NULL;
+    PyObject *tz_cache_stats = NULL;
 
-#if !CISO8601_CACHING_ENABLED
-    if (tzinfo != Py_None && tzinfo != utc)
-        Py_DECREF(tzinfo);
-#endif
+    if (result == NULL)
+        return NULL;
 
-    if (obj && time_is_midnight) {
-        delta = PyDelta_FromDSU(1, 0, 0); /* 1 day */
-        temp = obj;
-        obj = PyNumber_Add(temp, delta);
-        Py_DECREF(delta);
-        Py_DECREF(temp);
+    SET_COUNT(result, "parses", ciso8601_stats.parses)
+    SET_COUNT(result, "midnight_rollovers", ciso8601_stats.midnight_rollovers)
+
+    if ((formats = PyDict_New()) == NULL)
+        goto error;
+    SET_COUNT(formats, "calendar_basic", ciso8601_stats.calendar_basic)
+    SET_COUNT(formats, "calendar_extended", ciso8601_stats.calendar_extended)
+    SET_COUNT(formats, "ordinal_basic", ciso8601_stats.ordinal_basic)
+    SET_COUNT(formats, "ordinal_extended", ciso8601_stats.ordinal_extended)
+    SET_COUNT(formats, "week_basic", ciso8601_stats.week_basic)
+    SET_COUNT(formats, "week_extended", ciso8601_stats.week_extended)
+    if (PyDict_SetItemString(result, "formats", formats) < 0)
+        goto error;
+
+    if (_set_item(result, PyUnicode_FromString("fraction_digits"),
+                  _nonzero_counts(ciso8601_stats.fraction_digits,
+                                  STATS_MAX_FRACTION_DIGITS + 1, NULL)) < 0 ||
+        _set_item(result, PyUnicode_FromString("errors"),
+                  _nonzero_counts(ciso8601_stats.errors, STATS_ERROR_COUNT,
+                                  ciso8601_stats_error_names)) < 0)
+        goto error;
+
+#if CISO8601_CACHING_ENABLED
+    {
+        size_t i, entries = 0;
+
+        for (i = 0; i < sizeof(tz_cache) / sizeof(tz_cache[0]); i++)
+            entries += tz_cache[i] != NULL;
+
+        if ((tz_cache_stats = PyDict_New()) == NULL)
+            goto error;
+        SET_COUNT(tz_cache_stats, "hits", ciso8601_stats.tz_cache_hits)
+        SET_COUNT(tz_cache_stats, "misses", ciso8601_stats.tz_cache_misses)
+        if (_set_item(tz_cache_stats, PyUnicode_FromString("entries"),
+                      PyLong_FromSize_t(entries)) < 0)
+            goto error;
     }
+#else
+    tz_cache_stats = Py_None;
+    Py_INCREF(tz_cache_stats);
+#endif
+    if (PyDict_SetItemString(result, "tz_cache", tz_cache_stats) < 0)
+        goto error;
 
-    return obj;
-}
+    Py_DECREF(formats);
+    Py_DECREF(tz_cache_stats);
+    return result;
 
-static PyObject *
-parse_datetime_as_naive(PyObject *self, PyObject *dtstr)
-{
-    return _parse(self, dtstr, 0, 0);
+error:
+    Py_XDECREF(formats);
+    Py_XDECREF(tz_cache_stats);
+    Py_DECREF(result);
+    return NULL;
+#else
+    Py_RETURN_NONE;
+#endif
 }
 
 static PyObject *
-parse_datetime(PyObject *self, PyObject *dtstr)
+reset_stats(PyObject *self, PyObject *ignored)
 {
-    return _parse(self, dtstr, 1, 0);
-}
+#if CISO8601_STATS_ENABLED
+    uint64_t *counters = (uint64_t *)&ciso8601_stats;
+    size_t i;
 
-static PyObject *
-parse_rfc3339(PyObject *self, PyObject *dtstr)
-{
-    return _parse(self, dtstr, 1, 1);
+    for (i = 0; i < sizeof(ciso8601_stats) / sizeof(uint64_t); i++)
+        STATS_RESET(counters[i]);
+#endif
+    Py_RETURN_NONE;
 }
 
 static PyObject *
@@ -534,12 +2956,73 @@ _hard_coded_benchmark_timestamp(PyObject *self, PyObject *ignored)
 }
 
 static PyMethodDef CISO8601Methods[] = {
-    {"parse_datetime", (PyCFunction)parse_datetime, METH_O,
-     "Parse a ISO8601 date time string."},
+    {"parse_datetime", (PyCFunction)(void (*)(void))parse_datetime,
+     METH_FASTCALL | METH_KEYWORDS,
+     "Parse a ISO8601 date time string, localizing naive timestamps to the "
+     "IANA time zone `assume_tz` if it is given."},
     {"parse_datetime_as_naive", parse_datetime_as_naive, METH_O,
      "Parse a ISO8601 date time string, ignoring the time zone component."},
     {"parse_rfc3339", parse_rfc3339, METH_O,
      "Parse an RFC 3339 date time string."},
+    {"parse_date", parse_date, METH_O,
+     "Parse an ISO 8601 date string into a date."},
+    {"parse_time", parse_time, METH_O,
+     "Parse an ISO 8601 time string (with an optional time zone) into a "
+     "time."},
+    {"parse_rfc2822", parse_rfc2822, METH_O,
+     "Parse an RFC 2822 (e.g., email) date time string."},
+    {"parse_http_date", parse_http_date, METH_O,
+     "Parse an RFC 7231 HTTP-date string."},
+    {"parse_prefix", (PyCFunction)(void (*)(void))parse_prefix,
+     METH_VARARGS | METH_KEYWORDS,
+     "Parse the longest ISO8601 date time string found at the start of a "
+     "string (or at `pos`), returning the datetime and the index where it "
+     "ends."},
+    {"parse_bucket", (PyCFunction)(void (*)(void))parse_bucket,
+     METH_VARARGS | METH_KEYWORDS,
+     "Parse a ISO8601 date time string and floor it to the start of its UTC "
+     "minute, hour, day, ISO week, month or N-second bucket, returned as "
+     "seconds since the epoch."},
+    {"parse_bucket_many", (PyCFunction)(void (*)(void))parse_bucket_many,
+     METH_VARARGS | METH_KEYWORDS,
+     "Like `parse_bucket`, for each string of an iterable. Returns a list, "
+     "or writes the buckets to `out`."},
+    {"parse_epoch_many", (PyCFunction)(void (*)(void))parse_epoch_many,
+     METH_VARARGS | METH_KEYWORDS,
+     "Parse each string of an iterable into epoch microseconds, written to "
+     "the int64 buffer `out`."},
+    {"parse_delimited_column",
+     (PyCFunction)(void (*)(void))parse_delimited_column,
+     METH_VARARGS | METH_KEYWORDS,
+     "Parse one column of delimited (e.g., CSV) records in a bytes-like "
+     "object, after skipping the first `skip_rows` records (e.g., a header "
+     "row)."},
+    {"parse_timestamp_obj", parse_timestamp_obj, METH_O,
+     "Parse a ISO8601 date time string into a compact Timestamp, which only "
+     "builds a datetime when `to_datetime()` is called."},
+    {"argsort_timestamps", argsort_timestamps, METH_O,
+     "Return the indices that sort timestamp strings by instant."},
+    {"bisect_timestamps", (PyCFunction)(void (*)(void))bisect_timestamps,
+     METH_VARARGS | METH_KEYWORDS,
+     "Find where an instant belongs in timestamp strings sorted by "
+     "instant."},
+    {"timestamp_stats", (PyCFunction)(void (*)(void))timestamp_stats,
+     METH_VARARGS | METH_KEYWORDS,
+     "Compute the count, errors, min, max, monotonicity and (optionally) a "
+     "bucket histogram of timestamp strings, in a single pass."},
+    {"_fixed_offset", _fixed_offset, METH_O,
+     "Return the FixedOffset for the given offset (in seconds), reusing the "
+     "cached instance if there is one. Used when unpickling FixedOffsets."},
+    {"parse_duration", (PyCFunction)(void (*)(void))parse_duration,
+     METH_VARARGS | METH_KEYWORDS,
+     "Parse an ISO8601 duration (e.g., `P1DT12H`) into a timedelta."},
+    {"parse_interval", parse_interval, METH_O,
+     "Parse an ISO8601 time interval (`start/end`, `start/duration` or "
+     "`duration/end`) into a tuple of the start and end datetimes."},
+    {"stats", get_stats, METH_NOARGS,
+     "Return the counters of which parser paths were taken, or None if "
+     "ciso8601 was built without CISO8601_STATS_ENABLED=1."},
+    {"reset_stats", reset_stats, METH_NOARGS, "Reset the counters to zero."},
     {"_hard_coded_benchmark_timestamp", _hard_coded_benchmark_timestamp,
      METH_NOARGS,
      "Return a datetime using hardcoded values (for benchmarking purposes)"},
@@ -561,6 +3044,7 @@ PyMODINIT_FUNC
 PyInit_ciso8601(void)
 {
     PyObject *module = PyModule_Create(&moduledef);
+    PyObject *capsule;
     /* CISO8601_VERSION is defined in setup.py */
     PyModule_AddStringConstant(module, "__version__",
                                EXPAND_AND_STRINGIZE(CISO8601_VERSION));
@@ -571,6 +3055,35 @@ PyInit_ciso8601(void)
         return NULL;
     }
 
+    if (PyType_Ready(&Timestamp_type) < 0)
+        return NULL;
+    Py_INCREF(&Timestamp_type);
+    if (PyModule_AddObject(module, "Timestamp", (PyObject *)&Timestamp_type) <
+        0) {
+        Py_DECREF(&Timestamp_type);
+        Py_DECREF(module);
+        return NULL;
+    }
+
+    if (PyStructSequence_InitType2(&TimestampStats_type,
+                                   &TimestampStats_desc) < 0)
+        return NULL;
+    Py_INCREF(&TimestampStats_type);
+    if (PyModule_AddObject(module, "TimestampStats",
+                           (PyObject *)&TimestampStats_type) < 0) {
+        Py_DECREF(&TimestampStats_type);
+        Py_DECREF(module);
+        return NULL;
+    }
+
+    capsule = PyCapsule_New(&capi, CISO8601_CAPSULE_NAME, NULL);
+    if (capsule == NULL ||
+        PyModule_AddObject(module, "_C_API", capsule) < 0) {
+        Py_XDECREF(capsule);
+        Py_DECREF(module);
+        return NULL;
+    }
+
 #if SUPPORTS_37_TIMEZONE_API
     utc = PyDateTime_TimeZone_UTC;
 #else
@@ -0,0 +1,1243 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "isocalendar.h"
+#include "parser.h"
+#include "stats.h"
+
+/* `ymd_to_ord(1970, 1, 1)` */
+#define EPOCH_ORDINAL   719163
+#define SECONDS_PER_DAY 86400
+
+static ciso8601_error
+_fail(ciso8601_result *result, ciso8601_error error, size_t position,
+      const char *field, int value)
+{
+    result->error = error;
+    result->error_position = position;
+    result->error_field = field;
+    result->error_value = value;
+    STATS_ERROR(error, field);
+    return error;
+}
+
+/* `year` is also stored, as it is needed to describe an invalid ordinal day */
+#define FAIL_WITH_FIELD(error, field, value) \
+    (result->year = year, _fail(result, error, c - str, field, value))
+#define FAIL_WITH_VALUE(error, value) FAIL_WITH_FIELD(error, NULL, value)
+#define FAIL(error)                   FAIL_WITH_FIELD(error, NULL, 0)
+
+#define ORDINAL_DAY_ERROR(rv)                           \
+    ((rv) == -1 ? CISO8601_ERR_ORDINAL_DAY_TOO_SMALL \
+                : CISO8601_ERR_ORDINAL_DAY_TOO_LARGE)
+
+#define PARSE_INTEGER(field, length, field_name)                          \
+    for (i = 0; i < length; i++) {                                        \
+        if (c < end && *c >= '0' && *c <= '9') {                          \
+            field = 10 * field + *c++ - '0';                              \
+        }                                                                 \
+        else if (c >= end) {                                              \
+            return FAIL_WITH_FIELD(CISO8601_ERR_UNEXPECTED_END,           \
+                                   field_name, length - i);               \
+        }                                                                 \
+        else {                                                            \
+            return FAIL_WITH_FIELD(CISO8601_ERR_INVALID_CHARACTER,        \
+                                   field_name, 0);                        \
+        }                                                                 \
+    }
+
+#if CISO8601_STATS_ENABLED
+#define STATS_FRACTION_BEGIN() const char *fraction_start = c;
+#define STATS_FRACTION_END()   STATS_FRACTION(c - fraction_start);
+#else
+#define STATS_FRACTION_BEGIN()
+#define STATS_FRACTION_END()
+#endif
+
+#define PARSE_FRACTIONAL_SECOND()                                         \
+    STATS_FRACTION_BEGIN()                                                \
+    for (i = 0; i < 6; i++) {                                             \
+        if (c < end && *c >= '0' && *c <= '9') {                          \
+            usecond = 10 * usecond + *c++ - '0';                          \
+        }                                                                 \
+        else if (i == 0) {                                                \
+            /* We need at least one digit. */                             \
+            /* Trailing '.' or ',' is not allowed */                      \
+            return FAIL_WITH_FIELD(c >= end                               \
+                                       ? CISO8601_ERR_UNEXPECTED_END      \
+                                       : CISO8601_ERR_INVALID_CHARACTER,  \
+                                   "subsecond", 1);                       \
+        }                                                                 \
+        else                                                              \
+            break;                                                        \
+    }                                                                     \
+                                                                          \
+    /* Omit excessive digits */                                           \
+    while (c < end && *c >= '0' && *c <= '9') c++;                        \
+    STATS_FRACTION_END()                                                  \
+                                                                          \
+    /* If we break early, fully expand the usecond */                     \
+    while (i++ < 6) usecond *= 10;
+
+#define PARSE_SEPARATOR(separator, field_name)                           \
+    if (separator) {                                                     \
+        c++;                                                             \
+    }                                                                    \
+    else {                                                               \
+        return FAIL_WITH_FIELD(CISO8601_ERR_INVALID_CHARACTER, field_name, \
+                               0);                                       \
+    }
+
+#define IS_END_OF_STRING           (c >= end)
+#define IS_DIGIT_AT(p)             ((p) < end && *(p) >= '0' && *(p) <= '9')
+#define IS_CALENDAR_DATE_SEPARATOR (c < end && *c == '-')
+#define IS_ISOCALENDAR_SEPARATOR   (c < end && *c == 'W')
+#define IS_DATE_AND_TIME_SEPARATOR \
+    (c < end && (*c == 'T' || *c == ' ' || *c == 't'))
+#define IS_TIME_SEPARATOR (c < end && *c == ':')
+#define IS_TIME_ZONE_SEPARATOR \
+    (c < end && (*c == 'Z' || *c == '-' || *c == '+' || *c == 'z'))
+#define IS_FRACTIONAL_SEPARATOR \
+    (c < end && (*c == '.' || (*c == ',' && !rfc3339_only)))
+
+/* In prefix mode, parsing stops at the end of the longest valid timestamp
+ * rather than failing on whatever follows it. Each optional component is only
+ * entered if the characters that introduce it are actually present, so that
+ * trailing text is never mistaken for a malformed component.
+ */
+#define PREFIX_ALLOWS(condition) (!prefix || (condition))
+
+/* Fast paths for the most common layouts.
+ *
+ * Before the general parser below runs, the input is classified by its length
+ * and a few separator positions. Inputs in one of these layouts are then
+ * parsed by straight-line code, rather than by the general parser's
+ * character-by-character decisions. The fast paths only ever accept input that
+ * the general parser would accept with the same result. Anything unexpected (a
+ * non-digit, 24:00, an offset the general parser might reject, ...) falls back
+ * to the general parser, which also produces the detailed errors.
+ */
+typedef enum {
+    LAYOUT_OTHER,     /* Anything else, handled by the general parser */
+    LAYOUT_DATE,      /* YYYY-MM-DD */
+    LAYOUT_DATE_TIME, /* YYYY-MM-DDThh:mm:ss[.f], then nothing, Z or +hh:mm */
+} Layout;
+
+/* The value of the `length` digits at `p`, or -1 if they aren't all digits */
+static int
+_digits(const char *p, int length)
+{
+    int i, value = 0;
+
+    for (i = 0; i < length; i++) {
+        unsigned int digit = (unsigned char)p[i] - '0';
+        if (digit > 9)
+            return -1;
+        value = 10 * value + (int)digit;
+    }
+    return value;
+}
+
+/* For LAYOUT_DATE_TIME, `tz_length` is set to the length of the time zone
+ * designator at the end of the string (0, 1 or 6).
+ */
+static Layout
+_classify_layout(const char *str, size_t len, int flags, size_t *tz_length)
+{
+    char last;
+
+    if ((flags & (CISO8601_FLAG_PREFIX | CISO8601_FLAG_TIME_ONLY)) ||
+        len < 10 || str[4] != '-' || str[7] != '-')
+        return LAYOUT_OTHER;
+    if (len == 10)
+        return (flags & CISO8601_FLAG_RFC3339) ? LAYOUT_OTHER : LAYOUT_DATE;
+    if (len < 19 || (flags & CISO8601_FLAG_DATE_ONLY) ||
+        (str[10] != 'T' && str[10] != 't' && str[10] != ' ') ||
+        str[13] != ':' || str[16] != ':')
+        return LAYOUT_OTHER;
+
+    last = str[len - 1];
+    if ((last == 'Z' || last == 'z') && len >= 20)
+        *tz_length = 1;
+    else if (len >= 25 && (str[len - 6] == '+' || str[len - 6] == '-') &&
+             str[len - 3] == ':')
+        *tz_length = 6;
+    else if (flags & CISO8601_FLAG_RFC3339)
+        return LAYOUT_OTHER;
+    else
+        *tz_length = 0;
+    return LAYOUT_DATE_TIME;
+}
+
+static void
+_set_result(ciso8601_result *result, int year, int month, int day, int hour,
+            int minute, int second, int usecond, int has_tzinfo,
+            int tzminute, size_t consumed)
+{
+    result->year = year;
+    result->month = month;
+    result->day = day;
+    result->hour = hour;
+    result->minute = minute;
+    result->second = second;
+    result->usecond = usecond;
+    result->time_is_midnight = 0;
+    result->has_tzinfo = has_tzinfo;
+    result->tzminute = has_tzinfo ? tzminute : 0;
+    result->consumed = consumed;
+    result->error = CISO8601_OK;
+}
+
+/* Each of the layout parsers returns 1 if it parsed the input, or 0 if the
+ * general parser needs to handle it.
+ */
+static int
+_parse_date_layout(const char *str, ciso8601_result *result)
+{
+    int year = _digits(str, 4), month = _digits(str + 5, 2),
+        day = _digits(str + 8, 2);
+
+    if ((year | month | day) < 0)
+        return 0;
+
+    STATS_INC(calendar_extended);
+    _set_result(result, year, month, day, 0, 0, 0, 0, 0, 0, 10);
+    return 1;
+}
+
+static int
+_parse_date_time_layout(const char *str, size_t len, size_t tz_length,
+                        int flags, ciso8601_result *result)
+{
+    const char *c = str + 19;
+    const char *end = str + len - tz_length;
+    int year = _digits(str, 4), month = _digits(str + 5, 2),
+        day = _digits(str + 8, 2), hour = _digits(str + 11, 2),
+        minute = _digits(str + 14, 2), second = _digits(str + 17, 2);
+    int usecond = 0, digits = 0, tzhour = 0, tzminute = 0;
+
+    /* Also leaves 24:00:00 (which rolls over to the next day) to the general
+     * parser
+     */
+    if ((year | month | day | hour | minute | second) < 0 || hour == 24)
+        return 0;
+
+    if (c < end) { /* Fractional second */
+        if (*c != '.' && (*c != ',' || (flags & CISO8601_FLAG_RFC3339)))
+            return 0;
+        if (++c == end)
+            return 0;
+        for (; c < end; c++, digits++) {
+            unsigned int digit = (unsigned char)*c - '0';
+            if (digit > 9)
+                return 0;
+            if (digits < 6)
+                usecond = 10 * usecond + (int)digit;
+        }
+        for (; digits < 6; digits++) usecond *= 10;
+        STATS_FRACTION(c - str - 20);
+    }
+
+    if (tz_length == 6) {
+        /* Offsets of 24 hours or more are left to the general parser, as it
+         * only rejects them if the time zone is kept
+         */
+        tzhour = _digits(end + 1, 2);
+        tzminute = _digits(end + 4, 2);
+        if ((tzhour | tzminute) < 0 || tzhour > 23 || tzminute > 59)
+            return 0;
+        tzminute += 60 * tzhour;
+        if (*end == '-')
+            tzminute = -tzminute;
+    }
+
+    STATS_INC(calendar_extended);
+    _set_result(result, year, month, day, hour, minute, second, usecond,
+                tz_length != 0 && !(flags & CISO8601_FLAG_NAIVE), tzminute,
+                len);
+    return 1;
+}
+
+ciso8601_error
+ciso8601_parse(const char *str, size_t len, int flags,
+               ciso8601_result *result)
+{
+    int i;
+    const char *c = str;
+    const char *end = str + len;
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0,
+        usecond = 0;
+    int iso_week = 0, iso_day = 0;
+    int ordinal_day = 0;
+    int time_is_midnight = 0;
+    int tzhour = 0, tzminute = 0, tzsign = 0;
+    int has_tzinfo = 0;
+    int extended_date_format = 0;
+    int parse_any_tzinfo = !(flags & CISO8601_FLAG_NAIVE);
+    int rfc3339_only = flags & CISO8601_FLAG_RFC3339;
+    int prefix = flags & CISO8601_FLAG_PREFIX;
+    int date_only = flags & CISO8601_FLAG_DATE_ONLY;
+    int time_only = flags & CISO8601_FLAG_TIME_ONLY;
+
+    size_t tz_length = 0;
+
+    STATS_INC(parses);
+
+    switch (_classify_layout(str, len, flags, &tz_length)) {
+        case LAYOUT_DATE:
+            if (_parse_date_layout(str, result))
+                return CISO8601_OK;
+            break;
+        case LAYOUT_DATE_TIME:
+            if (_parse_date_time_layout(str, len, tz_length, flags, result))
+                return CISO8601_OK;
+            break;
+        default:
+            break;
+    }
+
+    if (time_only) {
+        /* The time designator is optional */
+        if (c < end && (*c == 'T' || *c == 't'))
+            c++;
+        /* Without a date, the time's own format (i.e., hh:mm or hhmm)
+         * decides which format the rest of it has to be in
+         */
+        extended_date_format = IS_DIGIT_AT(c) && c + 2 < end && c[2] == ':';
+    }
+    else {
+        /* Year */
+        PARSE_INTEGER(year, 4, "year")
+
+        /* Year validation is left to `ciso8601_validate` (or Python 3.6+
+         * datetime's C API constructor). See
+         * https://github.com/python/cpython/commit/b67f0967386a9c9041166d2bbe0a421bd81e10bc
+         */
+
+        if (IS_CALENDAR_DATE_SEPARATOR) {
+            c++;
+            extended_date_format = 1;
+
+            if (IS_ISOCALENDAR_SEPARATOR) { /* Separated ISO Calendar week
+                                               and day (i.e., Www-D) */
+                c++;
+                STATS_INC(week_extended);
+
+                if (rfc3339_only) {
+                    return FAIL(CISO8601_ERR_RFC3339_FORMAT);
+                }
+
+                PARSE_INTEGER(iso_week, 2, "iso_week")
+
+                if (!IS_END_OF_STRING && !IS_DATE_AND_TIME_SEPARATOR &&
+                    PREFIX_ALLOWS(IS_CALENDAR_DATE_SEPARATOR &&
+                                  IS_DIGIT_AT(c + 1))) { /* Optional Day */
+                    PARSE_SEPARATOR(IS_CALENDAR_DATE_SEPARATOR,
+                                    "date separator ('-')")
+                    PARSE_INTEGER(iso_day, 1, "iso_day")
+                }
+                else {
+                    iso_day = 1;
+                }
+
+                int rv =
+                    iso_to_ymd(year, iso_week, iso_day, &year, &month, &day);
+                if (rv) {
+                    return FAIL(CISO8601_ERR_INVALID_ISO_CALENDAR_DATE);
+                }
+            }
+            else { /* Separated month and may (i.e., MM-DD) or
+                      ordinal date (i.e., DDD) */
+                /* For sake of simplicity, we'll assume that it is a month
+                 * If we find out later that it's an ordinal day, then we'll
+                 * adjust
+                 */
+                PARSE_INTEGER(month, 2, "month")
+
+                if (!IS_END_OF_STRING && !IS_DATE_AND_TIME_SEPARATOR &&
+                    PREFIX_ALLOWS(IS_DIGIT_AT(c) ||
+                                  (IS_CALENDAR_DATE_SEPARATOR &&
+                                   IS_DIGIT_AT(c + 1) &&
+                                   IS_DIGIT_AT(c + 2)))) {
+                    if (IS_CALENDAR_DATE_SEPARATOR) { /* Optional day */
+                        c++;
+                        STATS_INC(calendar_extended);
+                        PARSE_INTEGER(day, 2, "day")
+                    }
+                    else { /* Ordinal day */
+                        STATS_INC(ordinal_extended);
+                        PARSE_INTEGER(ordinal_day, 1, "ordinal day")
+                        ordinal_day = (month * 10) + ordinal_day;
+
+                        int rv = ordinal_to_ymd(year, ordinal_day, &year,
+                                                &month, &day);
+                        if (rv) {
+                            return FAIL_WITH_VALUE(ORDINAL_DAY_ERROR(rv),
+                                                   ordinal_day);
+                        }
+                    }
+                }
+                else if (rfc3339_only) {
+                    return FAIL(CISO8601_ERR_RFC3339_FORMAT);
+                }
+                else {
+                    STATS_INC(calendar_extended);
+                    day = 1;
+                }
+            }
+        }
+        else if (rfc3339_only) {
+            return FAIL(CISO8601_ERR_RFC3339_FORMAT);
+        }
+        else {
+            if (IS_ISOCALENDAR_SEPARATOR) { /* Non-separated ISO Calendar
+                                               week and day (i.e., WwwD) */
+                c++;
+                STATS_INC(week_basic);
+
+                PARSE_INTEGER(iso_week, 2, "iso_week")
+
+                if (!IS_END_OF_STRING && !IS_DATE_AND_TIME_SEPARATOR &&
+                    PREFIX_ALLOWS(IS_DIGIT_AT(c))) { /* Optional Day */
+                    PARSE_INTEGER(iso_day, 1, "iso_day")
+                }
+                else {
+                    iso_day = 1;
+                }
+
+                int rv =
+                    iso_to_ymd(year, iso_week, iso_day, &year, &month, &day);
+                if (rv) {
+                    return FAIL(CISO8601_ERR_INVALID_ISO_CALENDAR_DATE);
+                }
+            }
+            else { /* Non-separated Month and Day (i.e., MMDD) or
+                      ordinal date (i.e., DDD)*/
+                /* For sake of simplicity, we'll assume that it is a month
+                 * If we find out later that it's an ordinal day, then we'll
+                 * adjust
+                 */
+                PARSE_INTEGER(month, 2, "month")
+
+                PARSE_INTEGER(ordinal_day, 1, "ordinal day")
+
+                if (IS_END_OF_STRING || IS_DATE_AND_TIME_SEPARATOR ||
+                    !PREFIX_ALLOWS(IS_DIGIT_AT(c))) { /* Ordinal day */
+                    STATS_INC(ordinal_basic);
+                    ordinal_day = (month * 10) + ordinal_day;
+                    int rv =
+                        ordinal_to_ymd(year, ordinal_day, &year, &month, &day);
+                    if (rv) {
+                        return FAIL_WITH_VALUE(ORDINAL_DAY_ERROR(rv),
+                                               ordinal_day);
+                    }
+                }
+                else { /* Day */
+                    /* Note that YYYYMM is not a valid timestamp. If the
+                     * calendar date is not separated, a day is required (i.e.,
+                     * YYMMDD)
+                     */
+                    STATS_INC(calendar_basic);
+                    PARSE_INTEGER(day, 1, "day")
+                    day = (ordinal_day * 10) + day;
+                }
+            }
+        }
+    }
+
+    /* Validation of date fields is left to `ciso8601_validate` (or Python
+     * 3.6+ datetime's C API constructor). See
+     * https://github.com/closeio/ciso8601/pull/30 and
+     * https://github.com/python/cpython/commit/b67f0967386a9c9041166d2bbe0a421bd81e10bc
+     */
+
+    if (time_only ||
+        (!date_only && !IS_END_OF_STRING &&
+         PREFIX_ALLOWS(IS_DATE_AND_TIME_SEPARATOR && IS_DIGIT_AT(c + 1) &&
+                       IS_DIGIT_AT(c + 2)))) {
+        if (!time_only) {
+            /* Date and time separator */
+            PARSE_SEPARATOR(IS_DATE_AND_TIME_SEPARATOR,
+                            "date and time separator (i.e., 'T', 't', or ' ')")
+        }
+
+        /* Hour */
+        PARSE_INTEGER(hour, 2, "hour")
+
+        if (!IS_END_OF_STRING && !IS_TIME_ZONE_SEPARATOR &&
+            PREFIX_ALLOWS(
+                extended_date_format
+                    ? (IS_TIME_SEPARATOR && IS_DIGIT_AT(c + 1) &&
+                       IS_DIGIT_AT(c + 2))
+                    : (IS_DIGIT_AT(c) &&
+                       IS_DIGIT_AT(c + 1)))) { /* Optional minute and second */
+
+            if (IS_TIME_SEPARATOR) { /* Separated Minute and Second
+                                      *  (i.e., mm:ss)
+                                      */
+                c++;
+
+                /* Minute */
+                PARSE_INTEGER(minute, 2, "minute")
+
+                if (!IS_END_OF_STRING && !IS_TIME_ZONE_SEPARATOR &&
+                    PREFIX_ALLOWS(IS_TIME_SEPARATOR && IS_DIGIT_AT(c + 1) &&
+                                  IS_DIGIT_AT(c + 2))) { /* Optional Second */
+                    PARSE_SEPARATOR(IS_TIME_SEPARATOR, "time separator (':')")
+
+                    /* Second */
+                    PARSE_INTEGER(second, 2, "second")
+
+                    /* Optional Fractional Second */
+                    if (IS_FRACTIONAL_SEPARATOR &&
+                        PREFIX_ALLOWS(IS_DIGIT_AT(c + 1))) {
+                        c++;
+                        PARSE_FRACTIONAL_SECOND()
+                    }
+                }
+                else if (rfc3339_only) {
+                    return FAIL(CISO8601_ERR_RFC3339_SECOND_REQUIRED);
+                }
+
+                if (!extended_date_format) {
+                    return FAIL(CISO8601_ERR_BASIC_DATE_WITH_EXTENDED_TIME);
+                }
+            }
+            else if (rfc3339_only) {
+                return FAIL(CISO8601_ERR_RFC3339_TIME_SEPARATORS_REQUIRED);
+            }
+            else { /* Non-separated Minute and Second (i.e., mmss) */
+                /* Minute */
+                PARSE_INTEGER(minute, 2, "minute")
+                if (!IS_END_OF_STRING && !IS_TIME_ZONE_SEPARATOR &&
+                    PREFIX_ALLOWS(IS_DIGIT_AT(c) &&
+                                  IS_DIGIT_AT(c + 1))) { /* Optional Second */
+                    /* Second */
+                    PARSE_INTEGER(second, 2, "second")
+
+                    /* Optional Fractional Second */
+                    if (IS_FRACTIONAL_SEPARATOR &&
+                        PREFIX_ALLOWS(IS_DIGIT_AT(c + 1))) {
+                        c++;
+                        PARSE_FRACTIONAL_SECOND()
+                    }
+                }
+
+                if (extended_date_format) {
+                    return FAIL(CISO8601_ERR_EXTENDED_DATE_WITH_BASIC_TIME);
+                }
+            }
+        }
+        else if (rfc3339_only) {
+            return FAIL(CISO8601_ERR_RFC3339_MINUTE_AND_SECOND_REQUIRED);
+        }
+
+        if (hour == 24 && minute == 0 && second == 0 && usecond == 0) {
+            /* Special case of 24:00:00, that is allowed in ISO 8601. It is
+             * equivalent to 00:00:00 the following day
+             */
+            if (rfc3339_only) {
+                return FAIL(CISO8601_ERR_RFC3339_HOUR_24);
+            }
+            hour = 0, minute = 0, second = 0, usecond = 0;
+            time_is_midnight = 1;
+            STATS_INC(midnight_rollovers);
+        }
+
+        /* Validation of hour/minute/second is left to `ciso8601_validate`
+         * (or Python 3.6+ datetime's constructor).
+         */
+
+        /* Optional tzinfo */
+        if (IS_TIME_ZONE_SEPARATOR &&
+            PREFIX_ALLOWS(*c == 'Z' || *c == 'z' ||
+                          (IS_DIGIT_AT(c + 1) && IS_DIGIT_AT(c + 2)))) {
+            if (*c == '+') {
+                tzsign = 1;
+            }
+            else if (*c == '-') {
+                tzsign = -1;
+            }
+            c++;
+
+            if (tzsign != 0) {
+                /* tz hour */
+                PARSE_INTEGER(tzhour, 2, "tz hour")
+
+                if (IS_TIME_SEPARATOR &&
+                    PREFIX_ALLOWS(IS_DIGIT_AT(c + 1) && IS_DIGIT_AT(c + 2))) {
+                    /* Optional separator */
+                    c++;
+                    /* tz minute */
+                    PARSE_INTEGER(tzminute, 2, "tz minute")
+                }
+                else if (rfc3339_only) {
+                    return FAIL(
+                        CISO8601_ERR_RFC3339_OFFSET_SEPARATOR_REQUIRED);
+                }
+                else if (!IS_END_OF_STRING &&
+                         PREFIX_ALLOWS(IS_DIGIT_AT(c) && IS_DIGIT_AT(c + 1))) {
+                    /* Optional tz minute */
+                    PARSE_INTEGER(tzminute, 2, "tz minute")
+                }
+            }
+
+            /* It's not entirely clear whether this validation check is
+             * necessary under ISO 8601. For now, we will err on the side of
+             * caution and prevent suspected invalid timestamps. If we need to
+             * loosen this restriction later, we can.
+             */
+            if (tzminute > 59) {
+                return FAIL(CISO8601_ERR_TZMINUTE_RANGE);
+            }
+
+            if (parse_any_tzinfo) {
+                tzminute += 60 * tzhour;
+                tzminute *= tzsign;
+
+                if (abs(tzminute) >= 1440) {
+                    return FAIL_WITH_VALUE(CISO8601_ERR_TZ_OFFSET_RANGE,
+                                           tzminute);
+                }
+                has_tzinfo = 1;
+            }
+        }
+        else if (rfc3339_only) {
+            return FAIL(CISO8601_ERR_RFC3339_OFFSET_REQUIRED);
+        }
+    }
+    else if (rfc3339_only) {
+        return FAIL(CISO8601_ERR_RFC3339_TIME_REQUIRED);
+    }
+
+    /* Unless in prefix mode, make sure that there is no more to parse. */
+    if (!prefix && !IS_END_OF_STRING) {
+        return FAIL(CISO8601_ERR_TRAILING_CHARACTERS);
+    }
+
+    result->year = year;
+    result->month = month;
+    result->day = day;
+    result->hour = hour;
+    result->minute = minute;
+    result->second = second;
+    result->usecond = usecond;
+    result->time_is_midnight = time_is_midnight;
+    result->has_tzinfo = has_tzinfo;
+    result->tzminute = has_tzinfo ? tzminute : 0;
+    result->consumed = c - str;
+    result->error = CISO8601_OK;
+    return CISO8601_OK;
+}
+
+
+ciso8601_error
+ciso8601_validate(ciso8601_result *result)
+{
+    ciso8601_error error = CISO8601_OK;
+
+    if (result->year < 1)
+        error = CISO8601_ERR_YEAR_RANGE;
+    else if (result->month < 1 || result->month > 12)
+        error = CISO8601_ERR_MONTH_RANGE;
+    else if (result->day < 1 ||
+             result->day > days_in_month(result->year, result->month))
+        error = CISO8601_ERR_DAY_RANGE;
+    else if (result->hour > 23)
+        error = CISO8601_ERR_HOUR_RANGE;
+    else if (result->minute > 59)
+        error = CISO8601_ERR_MINUTE_RANGE;
+    else if (result->second > 59)
+        error = CISO8601_ERR_SECOND_RANGE;
+
+    result->error = error;
+    if (error != CISO8601_OK)
+        STATS_ERROR(error, NULL);
+    return error;
+}
+
+int64_t
+ciso8601_epoch_seconds(const ciso8601_result *result)
+{
+    int64_t days = ymd_to_ord(result->year, result->month, result->day) -
+                   EPOCH_ORDINAL + result->time_is_midnight;
+
+    return days * SECONDS_PER_DAY + result->hour * 3600 +
+           result->minute * 60 + result->second - result->tzminute * 60;
+}
+
+static ciso8601_error
+_fail_duration(ciso8601_duration *duration, ciso8601_error error,
+               size_t position, const char *field, int value)
+{
+    duration->error = error;
+    duration->error_position = position;
+    duration->error_field = field;
+    duration->error_value = value;
+    return error;
+}
+
+#define DURATION_FAIL_WITH_FIELD(error, field, value) \
+    _fail_duration(duration, error, c - str, field, value)
+#define DURATION_FAIL(error) DURATION_FAIL_WITH_FIELD(error, NULL, 0)
+#define DURATION_FAIL_AT(field)                                        \
+    DURATION_FAIL_WITH_FIELD(IS_END_OF_STRING                          \
+                                 ? CISO8601_ERR_UNEXPECTED_END         \
+                                 : CISO8601_ERR_INVALID_CHARACTER,     \
+                             field, 1)
+
+ciso8601_error
+ciso8601_parse_duration(const char *str, size_t len,
+                        ciso8601_duration *duration)
+{
+    const char *c = str;
+    const char *end = str + len;
+    int next_component = CISO8601_DURATION_YEARS;
+    int in_time = 0, components = 0, has_fraction = 0, i;
+    int64_t value;
+    ciso8601_duration_component component;
+
+    memset(duration, 0, sizeof(*duration));
+
+    if (!IS_END_OF_STRING && (*c == '-' || *c == '+'))
+        duration->negative = *c++ == '-';
+
+    if (IS_END_OF_STRING || *c != 'P')
+        return DURATION_FAIL_AT("duration designator ('P')");
+    c++;
+
+    while (!IS_END_OF_STRING) {
+        if (*c == 'T') {
+            if (in_time)
+                return DURATION_FAIL(CISO8601_ERR_DURATION_ORDER);
+            in_time = 1;
+            next_component = CISO8601_DURATION_HOURS;
+            c++;
+            if (IS_END_OF_STRING)
+                return DURATION_FAIL_AT("duration component");
+            continue;
+        }
+
+        if (!IS_DIGIT_AT(c))
+            return DURATION_FAIL_AT("duration component");
+        for (value = 0; IS_DIGIT_AT(c); c++) {
+            value = 10 * value + *c - '0';
+            if (value > CISO8601_DURATION_MAX)
+                return DURATION_FAIL(CISO8601_ERR_DURATION_RANGE);
+        }
+
+        if (!IS_END_OF_STRING && (*c == '.' || *c == ',')) {
+            c++;
+            if (!IS_DIGIT_AT(c))
+                return DURATION_FAIL_AT("duration fraction");
+            for (i = 0; IS_DIGIT_AT(c); c++, i++) {
+                if (i < 9)
+                    duration->fraction = 10 * duration->fraction + *c - '0';
+            }
+            for (; i < 9; i++) duration->fraction *= 10;
+            has_fraction = 1;
+        }
+
+        if (IS_END_OF_STRING)
+            return DURATION_FAIL_AT("duration component designator");
+        switch (*c) {
+            case 'Y':
+                component = CISO8601_DURATION_YEARS;
+                break;
+            case 'M':
+                component = in_time ? CISO8601_DURATION_MINUTES
+                                    : CISO8601_DURATION_MONTHS;
+                break;
+            case 'W':
+                component = CISO8601_DURATION_WEEKS;
+                break;
+            case 'D':
+                component = CISO8601_DURATION_DAYS;
+                break;
+            case 'H':
+                component = CISO8601_DURATION_HOURS;
+                break;
+            case 'S':
+                component = CISO8601_DURATION_SECONDS;
+                break;
+            default:
+                return DURATION_FAIL_AT("duration component designator");
+        }
+        if ((component >= CISO8601_DURATION_HOURS) != in_time)
+            return DURATION_FAIL_AT("duration component designator");
+        if ((int)component < next_component)
+            return DURATION_FAIL(CISO8601_ERR_DURATION_ORDER);
+        c++;
+
+        duration->values[component] = value;
+        next_component = component + 1;
+        components++;
+
+        if (has_fraction) {
+            duration->fraction_component = component;
+            if (!IS_END_OF_STRING)
+                return DURATION_FAIL(CISO8601_ERR_DURATION_FRACTION);
+        }
+    }
+
+    if (components == 0)
+        return DURATION_FAIL(CISO8601_ERR_DURATION_EMPTY);
+
+    duration->error = CISO8601_OK;
+    return CISO8601_OK;
+}
+
+/* RFC 2822 and HTTP dates */
+
+static const char *const day_names[7] = {"mon", "tue", "wed", "thu",
+                                         "fri", "sat", "sun"};
+/* The rest of the full day names, as used by RFC 850 dates */
+static const char *const day_name_suffixes[7] = {
+    "day", "sday", "nesday", "rsday", "day", "urday", "day"};
+static const char *const month_names[12] = {"jan", "feb", "mar", "apr",
+                                            "may", "jun", "jul", "aug",
+                                            "sep", "oct", "nov", "dec"};
+
+/* The time zone names of RFC 2822's obsolete syntax (the same ones as
+ * Python's `email.utils`), with their offsets in minutes. Any other name of
+ * up to 5 letters is an unknown offset.
+ */
+static const struct {
+    const char *name;
+    int tzminute;
+} zone_names[] = {
+    {"ut", 0},       {"utc", 0},      {"gmt", 0},      {"z", 0},
+    {"ast", -4 * 60}, {"adt", -3 * 60}, {"est", -5 * 60}, {"edt", -4 * 60},
+    {"cst", -6 * 60}, {"cdt", -5 * 60}, {"mst", -7 * 60}, {"mdt", -6 * 60},
+    {"pst", -8 * 60}, {"pdt", -7 * 60},
+};
+
+#define IS_ALPHA_AT(p) \
+    ((p) < end && (*(p) | 0x20) >= 'a' && (*(p) | 0x20) <= 'z')
+#define IS_FWS   (c < end && (*c == ' ' || *c == '\t'))
+#define SKIP_FWS while (IS_FWS) c++;
+
+/* Like PARSE_SEPARATOR, but reports a missing separator at the end of the
+ * string as such
+ */
+#define PARSE_RFC2822_SEPARATOR(separator, field_name)                    \
+    if (IS_END_OF_STRING) {                                               \
+        return FAIL_WITH_FIELD(CISO8601_ERR_UNEXPECTED_END, field_name, 1); \
+    }                                                                     \
+    PARSE_SEPARATOR(separator, field_name)
+
+#define PARSE_MONTH_NAME()                                                  \
+    if ((month = _name_index(c, end, month_names, 12) + 1) == 0) {        \
+        if (c + 3 > end)                                                  \
+            return FAIL_WITH_FIELD(CISO8601_ERR_UNEXPECTED_END, "month",  \
+                                   (int)(c + 3 - end));                   \
+        return FAIL_WITH_FIELD(CISO8601_ERR_INVALID_CHARACTER, "month", 0); \
+    }                                                                     \
+    c += 3;
+
+/* Whether the `length` characters at `c` are `lowercase_name`, ignoring case
+ */
+static int
+_name_matches(const char *c, const char *end, const char *lowercase_name,
+              size_t length)
+{
+    size_t i;
+
+    if ((size_t)(end - c) < length)
+        return 0;
+    for (i = 0; i < length; i++) {
+        if ((c[i] | 0x20) != lowercase_name[i])
+            return 0;
+    }
+    return 1;
+}
+
+/* Returns the index of the three letter name at `c` in `names`, or -1 */
+static int
+_name_index(const char *c, const char *end, const char *const *names,
+            int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (_name_matches(c, end, names[i], 3))
+            return i;
+    }
+    return -1;
+}
+
+/* The fast path for IMF-fixdate, the preferred (and by far the most common)
+ * format of HTTP dates. Returns 1 if it parsed the input, or 0 if the general
+ * parser needs to handle it.
+ */
+static int
+_parse_imf_fixdate(const char *str, size_t len, int flags,
+                   ciso8601_result *result)
+{
+    const char *end = str + len;
+    int day, month, year, hour, minute, second;
+
+    if (len != 29 || str[3] != ',' || str[4] != ' ' || str[7] != ' ' ||
+        str[11] != ' ' || str[16] != ' ' || str[19] != ':' ||
+        str[22] != ':' || str[25] != ' ' || str[26] != 'G' ||
+        str[27] != 'M' || str[28] != 'T')
+        return 0;
+
+    day = _digits(str + 5, 2);
+    month = _name_index(str + 8, end, month_names, 12) + 1;
+    year = _digits(str + 12, 4);
+    hour = _digits(str + 17, 2);
+    minute = _digits(str + 20, 2);
+    second = _digits(str + 23, 2);
+    if ((day | year | hour | minute | second) < 0 || month == 0 ||
+        _name_index(str, end, day_names, 7) < 0)
+        return 0;
+
+    _set_result(result, year, month, day, hour, minute, second, 0,
+                !(flags & CISO8601_FLAG_NAIVE), 0, len);
+    return 1;
+}
+
+ciso8601_error
+ciso8601_parse_rfc2822(const char *str, size_t len, int flags,
+                       ciso8601_result *result)
+{
+    int i;
+    const char *c = str;
+    const char *end = str + len;
+    const char *start;
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    int tzhour = 0, tzminute = 0, has_tzinfo = 1;
+    int http = flags & CISO8601_FLAG_HTTP_DATE;
+    int asctime = 0, rfc850 = 0, day_of_week;
+
+    STATS_INC(parses);
+
+    if (_parse_imf_fixdate(str, len, flags, result))
+        return CISO8601_OK;
+
+    SKIP_FWS
+    if (IS_ALPHA_AT(c)) { /* Optional day of the week */
+        if ((day_of_week = _name_index(c, end, day_names, 7)) < 0)
+            return FAIL_WITH_FIELD(CISO8601_ERR_INVALID_CHARACTER,
+                                   "day of week", 0);
+        c += 3;
+        if (_name_matches(c, end, day_name_suffixes[day_of_week],
+                          strlen(day_name_suffixes[day_of_week]))) {
+            c += strlen(day_name_suffixes[day_of_week]);
+            rfc850 = http;
+        }
+
+        if (c < end && *c == ',') {
+            c++;
+        }
+        else if (http && !rfc850) { /* asctime() (e.g., "Sun Nov  6") */
+            asctime = 1;
+        }
+        else {
+            PARSE_RFC2822_SEPARATOR(0, "day of week separator (',')")
+        }
+        SKIP_FWS
+    }
+    else if (http) {
+        return FAIL_WITH_FIELD(IS_END_OF_STRING
+                                   ? CISO8601_ERR_UNEXPECTED_END
+                                   : CISO8601_ERR_INVALID_CHARACTER,
+                               "day of week", 3);
+    }
+
+    if (asctime) {
+        PARSE_MONTH_NAME()
+        PARSE_RFC2822_SEPARATOR(IS_FWS, "separator (' ')")
+        SKIP_FWS
+    }
+
+    /* Day, with one or two digits */
+    PARSE_INTEGER(day, 1, "day")
+    if (IS_DIGIT_AT(c))
+        day = 10 * day + *c++ - '0';
+
+    if (!asctime) {
+        /* RFC 850 dates separate the day, month and year with '-' */
+        if (rfc850) {
+            PARSE_RFC2822_SEPARATOR(IS_CALENDAR_DATE_SEPARATOR,
+                                    "date separator ('-')")
+        }
+        else {
+            PARSE_RFC2822_SEPARATOR(IS_FWS, "separator (' ')")
+            SKIP_FWS
+        }
+        PARSE_MONTH_NAME()
+        if (rfc850) {
+            PARSE_RFC2822_SEPARATOR(IS_CALENDAR_DATE_SEPARATOR,
+                                    "date separator ('-')")
+        }
+        else {
+            PARSE_RFC2822_SEPARATOR(IS_FWS, "separator (' ')")
+            SKIP_FWS
+        }
+
+        /* Year. Two and three digit years are obsolete (RFC 2822 section
+         * 4.3): 00-49 are 2000-2049, and anything else is relative to 1900.
+         */
+        start = c;
+        PARSE_INTEGER(year, 2, "year")
+        while (IS_DIGIT_AT(c) && c - start < 4) year = 10 * year + *c++ - '0';
+        if (c - start == 2)
+            year += year < 50 ? 2000 : 1900;
+        else if (c - start == 3)
+            year += 1900;
+    }
+
+    PARSE_RFC2822_SEPARATOR(IS_FWS, "separator (' ')")
+    SKIP_FWS
+
+    /* Time, where the second is optional */
+    PARSE_INTEGER(hour, 2, "hour")
+    PARSE_RFC2822_SEPARATOR(IS_TIME_SEPARATOR, "time separator (':')")
+    PARSE_INTEGER(minute, 2, "minute")
+    if (IS_TIME_SEPARATOR) {
+        c++;
+        PARSE_INTEGER(second, 2, "second")
+    }
+
+    if (IS_END_OF_STRING && asctime)
+        return FAIL_WITH_FIELD(CISO8601_ERR_UNEXPECTED_END, "year", 5);
+    if (IS_END_OF_STRING)
+        return FAIL_WITH_FIELD(CISO8601_ERR_UNEXPECTED_END, "time zone", 2);
+    PARSE_RFC2822_SEPARATOR(IS_FWS, "separator (' ')")
+    SKIP_FWS
+
+    if (asctime) {
+        PARSE_INTEGER(year, 4, "year")
+    }
+    else if (c < end && (*c == '+' || *c == '-')) { /* Numeric zone */
+        int tzsign;
+
+        if (http)
+            return FAIL(CISO8601_ERR_HTTP_DATE_ZONE);
+
+        tzsign = *c++ == '-' ? -1 : 1;
+        PARSE_INTEGER(tzhour, 2, "tz hour")
+        PARSE_INTEGER(tzminute, 2, "tz minute")
+        if (tzminute > 59)
+            return FAIL(CISO8601_ERR_TZMINUTE_RANGE);
+
+        /* "-0000" means that the offset from UTC is unknown */
+        if (tzsign == -1 && tzhour == 0 && tzminute == 0)
+            has_tzinfo = 0;
+        tzminute = tzsign * (60 * tzhour + tzminute);
+        if (has_tzinfo && !(flags & CISO8601_FLAG_NAIVE) &&
+            abs(tzminute) >= 1440)
+            return FAIL_WITH_VALUE(CISO8601_ERR_TZ_OFFSET_RANGE, tzminute);
+    }
+    else { /* Named zone */
+        start = c;
+        while (IS_ALPHA_AT(c)) c++;
+        for (i = 0; i < (int)(sizeof(zone_names) / sizeof(zone_names[0]));
+             i++) {
+            if ((size_t)(c - start) == strlen(zone_names[i].name) &&
+                _name_matches(start, c, zone_names[i].name, c - start))
+                break;
+        }
+        if (i < (int)(sizeof(zone_names) / sizeof(zone_names[0]))) {
+            if (http && strcmp(zone_names[i].name, "gmt") != 0) {
+                c = start;
+                return FAIL(CISO8601_ERR_HTTP_DATE_ZONE);
+            }
+            tzminute = zone_names[i].tzminute;
+        }
+        else if (!http && c > start && c - start <= 5) {
+            /* Other alphabetic zones (e.g., the military ones other than
+             * "Z") SHOULD be treated as "-0000" (RFC 5322 section 4.3)
+             */
+            has_tzinfo = 0;
+        }
+        else {
+            c = start;
+            return FAIL_WITH_FIELD(IS_END_OF_STRING
+                                       ? CISO8601_ERR_UNEXPECTED_END
+                                       : CISO8601_ERR_INVALID_CHARACTER,
+                                   "time zone", 1);
+        }
+    }
+
+    SKIP_FWS
+    if (!IS_END_OF_STRING)
+        return FAIL(CISO8601_ERR_TRAILING_CHARACTERS);
+
+    _set_result(result, year, month, day, hour, minute, second, 0,
+                has_tzinfo && !(flags & CISO8601_FLAG_NAIVE), tzminute, len);
+    return CISO8601_OK;
+}
+
+const char *
+ciso8601_strerror(ciso8601_error error)
+{
+    switch (error) {
+        case CISO8601_OK:
+            return "Success";
+        case CISO8601_ERR_UNEXPECTED_END:
+            return "Unexpected end of string";
+        case CISO8601_ERR_INVALID_CHARACTER:
+            return "Invalid character";
+        case CISO8601_ERR_TRAILING_CHARACTERS:
+            return "Unconverted data remains";
+        case CISO8601_ERR_INVALID_ISO_CALENDAR_DATE:
+            return "Invalid ISO Calendar date";
+        case CISO8601_ERR_ORDINAL_DAY_TOO_SMALL:
+            return "Invalid ordinal day: too small";
+        case CISO8601_ERR_ORDINAL_DAY_TOO_LARGE:
+            return "Invalid ordinal day: too large";
+        case CISO8601_ERR_BASIC_DATE_WITH_EXTENDED_TIME:
+            return "Cannot combine \"basic\" date format with \"extended\" "
+                   "time format (Should be either `YYYY-MM-DDThh:mm:ss` or "
+                   "`YYYYMMDDThhmmss`).";
+        case CISO8601_ERR_EXTENDED_DATE_WITH_BASIC_TIME:
+            return "Cannot combine \"extended\" date format with \"basic\" "
+                   "time format (Should be either `YYYY-MM-DDThh:mm:ss` or "
+                   "`YYYYMMDDThhmmss`).";
+        case CISO8601_ERR_TZMINUTE_RANGE:
+            return "tzminute must be in 0..59";
+        case CISO8601_ERR_TZ_OFFSET_RANGE:
+            return "UTC offset must be strictly between -24 and 24 hours";
+        case CISO8601_ERR_RFC3339_FORMAT:
+            return "Datetime string not in RFC 3339 format.";
+        case CISO8601_ERR_RFC3339_TIME_REQUIRED:
+            return "Time is mandatory in RFC 3339 format.";
+        case CISO8601_ERR_RFC3339_MINUTE_AND_SECOND_REQUIRED:
+            return "Minute and second are mandatory in RFC 3339";
+        case CISO8601_ERR_RFC3339_SECOND_REQUIRED:
+            return "RFC 3339 requires the second to be specified.";
+        case CISO8601_ERR_RFC3339_TIME_SEPARATORS_REQUIRED:
+            return "Colons separating time components are mandatory in RFC "
+                   "3339.";
+        case CISO8601_ERR_RFC3339_HOUR_24:
+            return "An hour value of 24, while sometimes legal in ISO 8601, "
+                   "is explicitly forbidden by RFC 3339.";
+        case CISO8601_ERR_RFC3339_OFFSET_REQUIRED:
+            return "UTC offset is mandatory in RFC 3339 format.";
+        case CISO8601_ERR_RFC3339_OFFSET_SEPARATOR_REQUIRED:
+            return "Separator between hour and minute in UTC offset is "
+                   "mandatory in RFC 3339";
+        case CISO8601_ERR_YEAR_RANGE:
+            return "year is out of range";
+        case CISO8601_ERR_MONTH_RANGE:
+            return "month must be in 1..12";
+        case CISO8601_ERR_DAY_RANGE:
+            return "day is out of range for month";
+        case CISO8601_ERR_HOUR_RANGE:
+            return "hour must be in 0..23";
+        case CISO8601_ERR_MINUTE_RANGE:
+            return "minute must be in 0..59";
+        case CISO8601_ERR_SECOND_RANGE:
+            return "second must be in 0..59";
+        case CISO8601_ERR_DURATION_EMPTY:
+            return "Duration must have at least one component";
+        case CISO8601_ERR_DURATION_ORDER:
+            return "Duration components must be given once each, in the "
+                   "order Y, M, W, D, T, H, M, S";
+        case CISO8601_ERR_DURATION_FRACTION:
+            return "Only the last component of a duration can have a "
+                   "fraction";
+        case CISO8601_ERR_DURATION_RANGE:
+            return "Duration component is too large";
+        case CISO8601_ERR_HTTP_DATE_ZONE:
+            return "HTTP dates must be in GMT";
+    }
+    return "Unknown error";
+}
+
+#if CISO8601_STATS_ENABLED
+Stats ciso8601_stats;
+
+const char *const ciso8601_stats_error_names[STATS_ERROR_COUNT] = {
+    "year",
+    "month",
+    "day",
+    "iso_week",
+    "iso_day",
+    "ordinal day",
+    "hour",
+    "minute",
+    "second",
+    "subsecond",
+    "tz hour",
+    "tz minute",
+    "tz offset",
+    "separator",
+    "iso calendar date",
+    "mixed basic and extended formats",
+    "trailing characters",
+    "rfc3339",
+    "day of week",
+    "time zone",
+    "http date zone",
+};
+
+void
+ciso8601_stats_count_error(ciso8601_error error, const char *field)
+{
+    StatsError index;
+
+    switch (error) {
+        case CISO8601_ERR_UNEXPECTED_END:
+        case CISO8601_ERR_INVALID_CHARACTER:
+            /* The field names used by PARSE_INTEGER (and the RFC 2822 names)
+             * match the stats names
+             */
+            for (index = 0; index < STATS_ERROR_COUNT; index++) {
+                if (strcmp(field, ciso8601_stats_error_names[index]) == 0)
+                    break;
+            }
+            if (index == STATS_ERROR_COUNT) /* i.e., PARSE_SEPARATOR */
+                index = STATS_ERROR_SEPARATOR;
+            break;
+        case CISO8601_ERR_TRAILING_CHARACTERS:
+            index = STATS_ERROR_TRAILING_CHARACTERS;
+            break;
+        case CISO8601_ERR_INVALID_ISO_CALENDAR_DATE:
+            index = STATS_ERROR_ISO_CALENDAR_DATE;
+            break;
+        case CISO8601_ERR_ORDINAL_DAY_TOO_SMALL:
+        case CISO8601_ERR_ORDINAL_DAY_TOO_LARGE:
+            index = STATS_ERROR_ORDINAL_DAY;
+            break;
+        case CISO8601_ERR_BASIC_DATE_WITH_EXTENDED_TIME:
+        case CISO8601_ERR_EXTENDED_DATE_WITH_BASIC_TIME:
+            index = STATS_ERROR_MIXED_FORMATS;
+            break;
+        case CISO8601_ERR_TZMINUTE_RANGE:
+            index = STATS_ERROR_TZ_MINUTE;
+            break;
+        case CISO8601_ERR_TZ_OFFSET_RANGE:
+            index = STATS_ERROR_TZ_OFFSET;
+            break;
+        case CISO8601_ERR_YEAR_RANGE:
+            index = STATS_ERROR_YEAR;
+            break;
+        case CISO8601_ERR_MONTH_RANGE:
+            index = STATS_ERROR_MONTH;
+            break;
+        case CISO8601_ERR_DAY_RANGE:
+            index = STATS_ERROR_DAY;
+            break;
+        case CISO8601_ERR_HOUR_RANGE:
+            index = STATS_ERROR_HOUR;
+            break;
+        case CISO8601_ERR_MINUTE_RANGE:
+            index = STATS_ERROR_MINUTE;
+            break;
+        case CISO8601_ERR_SECOND_RANGE:
+            index = STATS_ERROR_SECOND;
+            break;
+        case CISO8601_ERR_HTTP_DATE_ZONE:
+            index = STATS_ERROR_HTTP_DATE_ZONE;
+            break;
+        default: /* The RFC 3339 specific errors */
+            index = STATS_ERROR_RFC3339;
+            break;
+    }
+    STATS_INC(errors[index]);
+}
+#endif
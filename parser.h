@@ -0,0 +1,198 @@
+/* The ISO 8601 / RFC 3339 parser itself, independent of CPython.
+ *
+ * It only ever looks at the `len` bytes it is given (which don't need to be
+ * NUL terminated), never allocates, and has no global state, so it is safe to
+ * call without the GIL (or without Python at all, see `make lib`).
+ */
+#ifndef CISO8601_PARSER_H
+#define CISO8601_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Flags */
+/* Only accept RFC 3339 timestamps */
+#define CISO8601_FLAG_RFC3339 0x1
+/* Ignore time zone information (`has_tzinfo` will always be 0) */
+#define CISO8601_FLAG_NAIVE 0x2
+/* Stop at the end of the longest valid timestamp at the start of the input,
+ * rather than failing if there is anything after it. See `consumed`.
+ */
+#define CISO8601_FLAG_PREFIX 0x4
+/* `ciso8601_parse_rfc2822` only: only accept the HTTP-date formats of RFC
+ * 7231 (which are always in GMT)
+ */
+#define CISO8601_FLAG_HTTP_DATE 0x8
+/* Only accept a date, without a time */
+#define CISO8601_FLAG_DATE_ONLY 0x10
+/* Only accept a time (with an optional leading 'T' and time zone), without a
+ * date. The date fields of the result are left at 0.
+ */
+#define CISO8601_FLAG_TIME_ONLY 0x20
+
+typedef enum {
+    CISO8601_OK = 0,
+    /* `error_field` expected another `error_value` characters */
+    CISO8601_ERR_UNEXPECTED_END,
+    /* The character at `error_position` is not valid for `error_field` */
+    CISO8601_ERR_INVALID_CHARACTER,
+    /* `error_position` is the start of the unparsed characters */
+    CISO8601_ERR_TRAILING_CHARACTERS,
+    CISO8601_ERR_INVALID_ISO_CALENDAR_DATE,
+    /* `error_value` is the ordinal day, `year` is the year */
+    CISO8601_ERR_ORDINAL_DAY_TOO_SMALL,
+    CISO8601_ERR_ORDINAL_DAY_TOO_LARGE,
+    CISO8601_ERR_BASIC_DATE_WITH_EXTENDED_TIME,
+    CISO8601_ERR_EXTENDED_DATE_WITH_BASIC_TIME,
+    CISO8601_ERR_TZMINUTE_RANGE,
+    /* `error_value` is the offset, in minutes */
+    CISO8601_ERR_TZ_OFFSET_RANGE,
+
+    /* RFC 3339 specific */
+    CISO8601_ERR_RFC3339_FORMAT,
+    CISO8601_ERR_RFC3339_TIME_REQUIRED,
+    CISO8601_ERR_RFC3339_MINUTE_AND_SECOND_REQUIRED,
+    CISO8601_ERR_RFC3339_SECOND_REQUIRED,
+    CISO8601_ERR_RFC3339_TIME_SEPARATORS_REQUIRED,
+    CISO8601_ERR_RFC3339_HOUR_24,
+    CISO8601_ERR_RFC3339_OFFSET_REQUIRED,
+    CISO8601_ERR_RFC3339_OFFSET_SEPARATOR_REQUIRED,
+
+    /* Returned by `ciso8601_validate` */
+    CISO8601_ERR_YEAR_RANGE,
+    CISO8601_ERR_MONTH_RANGE,
+    CISO8601_ERR_DAY_RANGE,
+    CISO8601_ERR_HOUR_RANGE,
+    CISO8601_ERR_MINUTE_RANGE,
+    CISO8601_ERR_SECOND_RANGE,
+
+    /* Durations (see `ciso8601_parse_duration`) */
+    CISO8601_ERR_DURATION_EMPTY,
+    /* The designator at `error_position` is repeated or out of order */
+    CISO8601_ERR_DURATION_ORDER,
+    CISO8601_ERR_DURATION_FRACTION,
+    CISO8601_ERR_DURATION_RANGE,
+
+    /* RFC 2822 / HTTP dates (see `ciso8601_parse_rfc2822`) */
+    CISO8601_ERR_HTTP_DATE_ZONE,
+} ciso8601_error;
+
+typedef struct {
+    int year, month, day, hour, minute, second, usecond;
+    /* 24:00:00 was given, so the timestamp is 00:00:00 of the following day.
+     * The other fields are 00:00:00 of the given day.
+     */
+    int time_is_midnight;
+    int has_tzinfo;
+    /* Offset from UTC in minutes, in the range (-1440, 1440) exclusive */
+    int tzminute;
+
+    /* Number of bytes that make up the timestamp */
+    size_t consumed;
+
+    ciso8601_error error;
+    /* Index of the byte that caused the error */
+    size_t error_position;
+    /* Name of the component that was being parsed (e.g., "month") */
+    const char *error_field;
+    /* Additional detail, as documented for each error code */
+    int error_value;
+} ciso8601_result;
+
+/* Parses `len` bytes starting at `str`. Returns CISO8601_OK, or an error code
+ * (which is also stored in `result->error`).
+ *
+ * Field values are only checked as far as the grammar requires (e.g., a month
+ * of 13 is accepted). Use `ciso8601_validate` to check them.
+ */
+ciso8601_error
+ciso8601_parse(const char *str, size_t len, int flags,
+               ciso8601_result *result);
+
+/* Checks that the fields of a successfully parsed timestamp make up a real
+ * date and time (in the range supported by Python's datetime).
+ */
+ciso8601_error
+ciso8601_validate(ciso8601_result *result);
+
+/* Seconds since 1970-01-01T00:00:00Z of a validated result, ignoring the
+ * microseconds. Naive timestamps are treated as though they were in UTC.
+ */
+int64_t
+ciso8601_epoch_seconds(const ciso8601_result *result);
+
+/* The components of a duration, in the order they must appear in */
+typedef enum {
+    CISO8601_DURATION_YEARS,
+    CISO8601_DURATION_MONTHS,
+    CISO8601_DURATION_WEEKS,
+    CISO8601_DURATION_DAYS,
+    CISO8601_DURATION_HOURS,
+    CISO8601_DURATION_MINUTES,
+    CISO8601_DURATION_SECONDS,
+    CISO8601_DURATION_COMPONENTS
+} ciso8601_duration_component;
+
+/* Largest value of a single duration component */
+#define CISO8601_DURATION_MAX 999999999
+
+typedef struct {
+    /* A leading '-' was given (as allowed by ISO 8601-2) */
+    int negative;
+    /* Indexed by ciso8601_duration_component. Components that weren't given
+     * are 0.
+     */
+    int64_t values[CISO8601_DURATION_COMPONENTS];
+    /* Only the last component may have a fraction, in billionths of its unit
+     * (further digits are truncated)
+     */
+    int32_t fraction;
+    ciso8601_duration_component fraction_component;
+
+    /* As for ciso8601_result */
+    ciso8601_error error;
+    size_t error_position;
+    const char *error_field;
+    int error_value;
+} ciso8601_duration;
+
+/* Parses the `len` bytes starting at `str` as an ISO 8601 duration in the
+ * format with designators (i.e., `PnYnMnWnDTnHnMnS`, such as `P1DT12H`).
+ * Returns CISO8601_OK, or an error code (which is also stored in
+ * `duration->error`).
+ */
+ciso8601_error
+ciso8601_parse_duration(const char *str, size_t len,
+                        ciso8601_duration *duration);
+
+/* Parses the `len` bytes starting at `str` as an RFC 2822 (RFC 5322) date and
+ * time, such as `Sun, 06 Nov 1994 08:49:37 +0100`. The obsolete syntax (two
+ * digit years and named time zones) is accepted. A zone of `-0000`, or a name
+ * other than those of RFC 822 (e.g., the military zones other than `Z`),
+ * means that the offset is unknown, so the result is naive.
+ *
+ * With CISO8601_FLAG_HTTP_DATE, the three HTTP-date formats of RFC 7231 are
+ * accepted instead: IMF-fixdate (`Sun, 06 Nov 1994 08:49:37 GMT`), the
+ * obsolete RFC 850 format (`Sunday, 06-Nov-94 08:49:37 GMT`) and ANSI C's
+ * asctime() format (`Sun Nov  6 08:49:37 1994`).
+ *
+ * CISO8601_FLAG_NAIVE is also supported. As for `ciso8601_parse`, the fields
+ * still need to be checked with `ciso8601_validate`.
+ */
+ciso8601_error
+ciso8601_parse_rfc2822(const char *str, size_t len, int flags,
+                       ciso8601_result *result);
+
+/* Human readable description of an error code */
+const char *
+ciso8601_strerror(ciso8601_error error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
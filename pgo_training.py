@@ -0,0 +1,93 @@
+# The training workload for profile-guided optimization builds (`CISO8601_PGO=1`, see setup.py).
+# It is run against the instrumented extension, so its mix of inputs determines which paths the final build is optimized for.
+import random
+import sys
+
+import ciso8601
+
+try:
+    from generate_test_timestamps import generate_invalid_timestamp, generate_valid_timestamp_and_datetime
+except ImportError:
+    # `generate_test_timestamps` needs pytz, which might not be installed at build time
+    generate_invalid_timestamp = generate_valid_timestamp_and_datetime = None
+
+# Used if `generate_test_timestamps` isn't available. In rough order of how common they are in practice.
+FALLBACK_VALID_TIMESTAMPS = [
+    "2014-12-05T12:30:45.123456Z",
+    "2014-12-05T12:30:45Z",
+    "2014-12-05T12:30:45.123456+05:30",
+    "2014-12-05T12:30:45-08:00",
+    "2014-12-05 12:30:45.123456",
+    "2014-12-05T12:30:45",
+    "2014-12-05T12:30",
+    "2014-12-05",
+    "2014-12-05T12:30:45.123Z",
+    "2014-12-05T12:30:45,123456+0530",
+    "20141205T123045Z",
+    "20141205",
+    "2014-339",
+    "2014339T1230",
+    "2014-W49-5T12:30:45",
+    "2014W495",
+    "2014-12-05T24:00:00",
+]
+FALLBACK_INVALID_TIMESTAMPS = [
+    "2014-12-0",
+    "2014-12-05T12:30:45Zjunk",
+    "2014-13-05",
+    "2014-12-05T12:3a",
+    "20141205T12:30",
+]
+
+ROUNDS = 200
+
+
+def corpus(seed=8601):
+    if generate_valid_timestamp_and_datetime is None:
+        return FALLBACK_VALID_TIMESTAMPS, FALLBACK_INVALID_TIMESTAMPS
+
+    rng = random.Random(seed)
+    valid = []
+    invalid = []
+    for _ in range(5):
+        params = {
+            "year": rng.randint(1, 9999),
+            "month": rng.randint(1, 12),
+            "day": rng.randint(1, 28),
+            "iso_week": rng.randint(1, 52),
+            "iso_day": rng.randint(1, 7),
+            "ordinal_day": rng.randint(1, 365),
+            "hour": rng.randint(0, 23),
+            "minute": rng.randint(0, 59),
+            "second": rng.randint(0, 59),
+            "microsecond": rng.randint(0, 999999),
+            "tzhour": rng.randint(0, 23),
+            "tzminute": rng.randint(0, 59),
+        }
+        valid.extend(timestamp for timestamp, _datetime in generate_valid_timestamp_and_datetime(**params))
+        invalid.extend(timestamp for timestamp, _reason in generate_invalid_timestamp(**params))
+    # Errors are the exception in real workloads, so they shouldn't dominate the profile
+    return valid + FALLBACK_VALID_TIMESTAMPS * 10, invalid[:len(valid) // 20] + FALLBACK_INVALID_TIMESTAMPS
+
+
+def train():
+    valid, invalid = corpus()
+    functions = [ciso8601.parse_datetime, ciso8601.parse_datetime_as_naive, ciso8601.parse_rfc3339]
+    for _ in range(ROUNDS):
+        for timestamp in valid:
+            for function in functions:
+                try:
+                    function(timestamp)
+                except ValueError:
+                    pass
+        for timestamp in invalid:
+            try:
+                ciso8601.parse_datetime(timestamp)
+            except ValueError:
+                pass
+        ciso8601.parse_bucket_many(valid[:100], "hour")
+    sys.stdout.write("Trained on {0} valid and {1} invalid timestamps\n".format(len(valid), len(invalid)))
+
+
+if __name__ == "__main__":
+    train()
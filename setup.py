@@ -1,6 +1,11 @@
+import glob
 import os
+import shutil
+import subprocess
+import sys
 
 from setuptools import setup, Extension
+from setuptools.command.build_ext import build_ext
 
 with open("README.rst", encoding="utf-8") as file:
     long_description = file.read()
@@ -30,6 +35,80 @@ if os.environ.get("STRICT_WARNINGS", "0") == "1":
 
 VERSION = "2.3.3"
 CISO8601_CACHING_ENABLED = int(os.environ.get('CISO8601_CACHING_ENABLED', '1') == '1')
+CISO8601_STATS_ENABLED = int(os.environ.get('CISO8601_STATS_ENABLED', '0') == '1')
+CISO8601_PGO = os.environ.get('CISO8601_PGO', '0') == '1'
+
+
+class PGOBuildExt(build_ext):
+    """
+    Profile-guided optimization build (`CISO8601_PGO=1`).
+
+    Builds an instrumented extension, runs `pgo_training.py` against it to collect a profile, and then rebuilds the
+    extension with that profile (and link-time optimization). Only GCC and Clang are supported; with any other
+    compiler (or if Clang's `llvm-profdata` can't be found), this falls back to a regular build.
+    """
+
+    def build_extensions(self):
+        if self.compiler.compiler_type != "unix":
+            self.warn("CISO8601_PGO=1 is only supported with GCC and Clang. Doing a regular build.")
+            return build_ext.build_extensions(self)
+
+        profile_dir = os.path.abspath(os.path.join(self.build_temp, "pgo"))
+        shutil.rmtree(profile_dir, ignore_errors=True)
+        os.makedirs(profile_dir)
+
+        if self._is_clang():
+            profdata = self._find_llvm_profdata()
+            if profdata is None:
+                self.warn("CISO8601_PGO=1 needs llvm-profdata to build with Clang. Doing a regular build.")
+                return build_ext.build_extensions(self)
+            profile = os.path.join(profile_dir, "ciso8601.profdata")
+            generate_flags = ["-fprofile-instr-generate"]
+            use_flags = ["-fprofile-instr-use={0}".format(profile)]
+            env = {"LLVM_PROFILE_FILE": os.path.join(profile_dir, "%p.profraw")}
+        else:
+            generate_flags = ["-fprofile-generate={0}".format(profile_dir)]
+            # -fprofile-correction: the counters can be slightly inconsistent if the training run used several threads
+            use_flags = ["-fprofile-use={0}".format(profile_dir), "-fprofile-correction"]
+            env = {}
+
+        # The object files of both stages must be built, so that the profile is always from this build
+        self.force = True
+        self._build_with_flags(generate_flags)
+        self._train(env)
+        if self._is_clang():
+            subprocess.check_call(profdata + ["merge", "-output={0}".format(profile)] + glob.glob(os.path.join(profile_dir, "*.profraw")))
+        self._build_with_flags(use_flags + ["-flto"])
+
+    def _build_with_flags(self, flags):
+        for ext in self.extensions:
+            ext.extra_compile_args = flags
+            ext.extra_link_args = flags
+        build_ext.build_extensions(self)
+
+    def _train(self, env):
+        # Runs the training workload against the instrumented extension (and not any other build of ciso8601).
+        # With `-m`, the working directory (rather than the script's directory) comes first in `sys.path`.
+        source_dir = os.path.dirname(os.path.abspath(__file__))
+        extension_dir = os.path.dirname(os.path.abspath(self.get_ext_fullpath("ciso8601")))
+        env = dict(os.environ, PYTHONPATH=os.pathsep.join([extension_dir, source_dir]), **env)
+        subprocess.check_call([sys.executable, "-m", "pgo_training"], cwd=extension_dir, env=env)
+
+    def _is_clang(self):
+        try:
+            output = subprocess.check_output(self.compiler.compiler_so[:1] + ["--version"], universal_newlines=True)
+        except (OSError, subprocess.CalledProcessError):
+            return False
+        return "clang" in output
+
+    @staticmethod
+    def _find_llvm_profdata():
+        if shutil.which("llvm-profdata") is not None:
+            return ["llvm-profdata"]
+        if sys.platform == "darwin" and shutil.which("xcrun") is not None:
+            return ["xcrun", "llvm-profdata"]
+        return None
+
 
 setup(
     name="ciso8601",
@@ -42,15 +121,17 @@ setup(
     ext_modules=[
         Extension(
             "ciso8601",
-            sources=["module.c", "timezone.c", "isocalendar.c"],
+            sources=["module.c", "parser.c", "timezone.c", "isocalendar.c", "tzfile.c"],
             define_macros=[
                 ("CISO8601_VERSION", VERSION),
                 ("CISO8601_CACHING_ENABLED", CISO8601_CACHING_ENABLED),
+                ("CISO8601_STATS_ENABLED", CISO8601_STATS_ENABLED),
             ],
         )
     ],
+    cmdclass={"build_ext": PGOBuildExt} if CISO8601_PGO else {},
     packages=["ciso8601"],
-    package_data={"ciso8601": ["__init__.pyi", "py.typed"]},
+    package_data={"ciso8601": ["__init__.pyi", "py.typed", "ciso8601.h"]},
     test_suite="tests",
     tests_require=[
         "pytz",
@@ -0,0 +1,105 @@
+/* Optional counters of which parser paths are taken, enabled by building with
+ * CISO8601_STATS_ENABLED=1. When disabled, all of the STATS_* macros expand to
+ * nothing, so there is no overhead at all.
+ *
+ * The counters are process-wide and updated with relaxed atomic increments, so
+ * that they stay consistent when parsing from several threads (or without the
+ * GIL). Each counter is exact, but a snapshot of all of them isn't taken
+ * atomically.
+ */
+#ifndef CISO8601_STATS_H
+#define CISO8601_STATS_H
+
+#if CISO8601_STATS_ENABLED
+
+#include <stdint.h>
+
+#include "parser.h"
+
+/* Fraction lengths of STATS_MAX_FRACTION_DIGITS or more share the last bucket
+ */
+#define STATS_MAX_FRACTION_DIGITS 15
+
+/* What an error is counted against: the field being parsed, or the kind of
+ * error if it isn't about a single field.
+ */
+typedef enum {
+    STATS_ERROR_YEAR,
+    STATS_ERROR_MONTH,
+    STATS_ERROR_DAY,
+    STATS_ERROR_ISO_WEEK,
+    STATS_ERROR_ISO_DAY,
+    STATS_ERROR_ORDINAL_DAY,
+    STATS_ERROR_HOUR,
+    STATS_ERROR_MINUTE,
+    STATS_ERROR_SECOND,
+    STATS_ERROR_SUBSECOND,
+    STATS_ERROR_TZ_HOUR,
+    STATS_ERROR_TZ_MINUTE,
+    STATS_ERROR_TZ_OFFSET,
+    STATS_ERROR_SEPARATOR,
+    STATS_ERROR_ISO_CALENDAR_DATE,
+    STATS_ERROR_MIXED_FORMATS,
+    STATS_ERROR_TRAILING_CHARACTERS,
+    STATS_ERROR_RFC3339,
+    /* RFC 2822 and HTTP dates */
+    STATS_ERROR_DAY_OF_WEEK,
+    STATS_ERROR_TIME_ZONE,
+    STATS_ERROR_HTTP_DATE_ZONE,
+    STATS_ERROR_COUNT
+} StatsError;
+
+/* Every member is a uint64_t, so that they can all be reset in a loop */
+typedef struct {
+    uint64_t parses;
+    uint64_t calendar_basic, calendar_extended;
+    uint64_t ordinal_basic, ordinal_extended;
+    uint64_t week_basic, week_extended;
+    uint64_t fraction_digits[STATS_MAX_FRACTION_DIGITS + 1];
+    uint64_t midnight_rollovers;
+    uint64_t tz_cache_hits, tz_cache_misses;
+    uint64_t errors[STATS_ERROR_COUNT];
+} Stats;
+
+extern Stats ciso8601_stats;
+
+/* Names of the StatsError values, as used by `ciso8601.stats()` */
+extern const char *const ciso8601_stats_error_names[STATS_ERROR_COUNT];
+
+void
+ciso8601_stats_count_error(ciso8601_error error, const char *field);
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define STATS_ADD(counter, n) \
+    _InterlockedExchangeAdd64((volatile __int64 *)&(counter), (n))
+#define STATS_LOAD(counter)                                                 \
+    ((uint64_t)_InterlockedCompareExchange64((volatile __int64 *)&(counter), \
+                                             0, 0))
+#define STATS_RESET(counter) \
+    _InterlockedExchange64((volatile __int64 *)&(counter), 0)
+#else
+#define STATS_ADD(counter, n) \
+    __atomic_fetch_add(&(counter), (n), __ATOMIC_RELAXED)
+#define STATS_LOAD(counter)  __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define STATS_RESET(counter) __atomic_store_n(&(counter), 0, __ATOMIC_RELAXED)
+#endif
+
+#define STATS_INC(name)           STATS_ADD(ciso8601_stats.name, 1)
+#define STATS_ERROR(error, field) ciso8601_stats_count_error(error, field)
+#define STATS_FRACTION(digits)                                  \
+    STATS_ADD(ciso8601_stats.fraction_digits                    \
+                  [(digits) < STATS_MAX_FRACTION_DIGITS         \
+                       ? (digits)                               \
+                       : STATS_MAX_FRACTION_DIGITS],            \
+              1)
+
+#else
+
+#define STATS_INC(name)           ((void)0)
+#define STATS_ERROR(error, field) ((void)0)
+#define STATS_FRACTION(digits)    ((void)0)
+
+#endif
+
+#endif
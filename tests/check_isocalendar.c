@@ -0,0 +1,126 @@
+/* Exhaustively checks `ord_to_ymd` and `ymd_to_ord` against the algorithms
+ * they replaced (ported from CPython's `Modules/_datetimemodule.c`), for
+ * every day of the years 1..9999 (and that year 0 round-trips).
+ *
+ * Usage: make check
+ */
+#include <stdio.h>
+
+#include "isocalendar.h"
+
+/* 31-Dec-9999 */
+#define MAX_ORDINAL 3652059
+
+static const int _days_before_month[] = {
+    0, /* unused; this vector uses 1-based indexing */
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365,
+};
+
+static int
+is_leap(int year)
+{
+    return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+static int
+reference_ymd_to_ord(int year, int month, int day)
+{
+    int y = year - 1;
+
+    return y * 365 + y / 4 - y / 100 + y / 400 + _days_before_month[month] +
+           (month > 2 && is_leap(year)) + day;
+}
+
+static void
+reference_ord_to_ymd(int ordinal, int *year, int *month, int *day)
+{
+    int n, n1, n4, n100, n400, leapyear, preceding;
+
+    --ordinal;
+    n400 = ordinal / 146097;
+    n = ordinal % 146097;
+    *year = n400 * 400 + 1;
+
+    n100 = n / 36524;
+    n = n % 36524;
+    n4 = n / 1461;
+    n = n % 1461;
+    n1 = n / 365;
+    n = n % 365;
+
+    *year += n100 * 100 + n4 * 4 + n1;
+    if (n1 == 4 || n100 == 4) {
+        *year -= 1;
+        *month = 12;
+        *day = 31;
+        return;
+    }
+
+    leapyear = n1 == 3 && (n4 != 24 || n100 == 3);
+    *month = (n + 50) >> 5;
+    preceding = (_days_before_month[*month] + (*month > 2 && leapyear));
+    if (preceding > n) {
+        *month -= 1;
+        preceding -= days_in_month(*year, *month);
+    }
+    *day = n - preceding + 1;
+}
+
+int
+main(void)
+{
+    int ordinal, year, month, day;
+    int expected_year, expected_month, expected_day;
+    int failures = 0;
+
+    for (ordinal = 1; ordinal <= MAX_ORDINAL; ordinal++) {
+        ord_to_ymd(ordinal, &year, &month, &day);
+        reference_ord_to_ymd(ordinal, &expected_year, &expected_month,
+                             &expected_day);
+        if (year != expected_year || month != expected_month ||
+            day != expected_day) {
+            fprintf(stderr,
+                    "ord_to_ymd(%d) = %04d-%02d-%02d, expected "
+                    "%04d-%02d-%02d\n",
+                    ordinal, year, month, day, expected_year, expected_month,
+                    expected_day);
+            failures++;
+        }
+
+        if (ymd_to_ord(expected_year, expected_month, expected_day) !=
+            ordinal) {
+            fprintf(stderr, "ymd_to_ord(%04d, %02d, %02d) = %d, expected %d\n",
+                    expected_year, expected_month, expected_day,
+                    ymd_to_ord(expected_year, expected_month, expected_day),
+                    ordinal);
+            failures++;
+        }
+
+        if (reference_ymd_to_ord(expected_year, expected_month,
+                                 expected_day) != ordinal) {
+            fprintf(stderr, "Reference implementations disagree on %d\n",
+                    ordinal);
+            failures++;
+        }
+
+        if (failures > 10)
+            break;
+    }
+
+    /* Year 0 isn't valid, but `iso_to_ymd` relies on it round-tripping */
+    for (ordinal = -365; ordinal <= 0; ordinal++) {
+        ord_to_ymd(ordinal, &year, &month, &day);
+        if (year != 0 || ymd_to_ord(year, month, day) != ordinal) {
+            fprintf(stderr, "ord_to_ymd(%d) = %04d-%02d-%02d\n", ordinal,
+                    year, month, day);
+            failures++;
+        }
+    }
+
+    if (failures) {
+        fprintf(stderr, "FAILED\n");
+        return 1;
+    }
+    printf("OK (%d days)\n", MAX_ORDINAL);
+    return 0;
+}
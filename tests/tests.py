@@ -1,14 +1,28 @@
 # -*- coding: utf-8 -*-
 
+import array
+import bisect
 import copy
+import csv
+import ctypes
 import datetime
+import email.utils
+import io
+import os
 import pickle
 import platform
 import re
+import struct
 import sys
+import tempfile
 import unittest
 
-from ciso8601 import _hard_coded_benchmark_timestamp, FixedOffset, parse_datetime, parse_datetime_as_naive, parse_rfc3339
+try:
+    import zoneinfo
+except ImportError:  # Python 3.8
+    zoneinfo = None
+
+from ciso8601 import _C_API, _hard_coded_benchmark_timestamp, argsort_timestamps, bisect_timestamps, FixedOffset, parse_bucket, parse_bucket_many, parse_date, parse_datetime, parse_datetime_as_naive, parse_delimited_column, parse_duration, parse_epoch_many, parse_interval, parse_http_date, parse_prefix, parse_rfc2822, parse_rfc3339, parse_time, parse_timestamp_obj, reset_stats, stats, Timestamp, timestamp_stats, TimestampStats
 from generate_test_timestamps import generate_valid_timestamp_and_datetime, generate_invalid_timestamp
 
 if sys.version_info.major == 2:
@@ -54,6 +68,29 @@ class ValidTimestampTestCase(unittest.TestCase):
             datetime.datetime(2014, 2, 4, 0, 0, 0),
         )
 
+    def test_common_layouts_match_general_parser(self):
+        # `YYYY-MM-DD` and `YYYY-MM-DDThh:mm:ss[.f][Z|+hh:mm]` take a fast path, which must give the same results as the
+        # general parser (which `parse_prefix` always uses), and leave anything unusual to it
+        for timestamp in [
+            "2014-02-03",
+            "2014-02-03T01:23:45",
+            "2014-02-03 01:23:45",
+            "2014-02-03t01:23:45z",
+            "2014-02-03T01:23:45Z",
+            "2014-02-03T01:23:45.1",
+            "2014-02-03T01:23:45,123456789",
+            "2014-02-03T01:23:45.123456+04:30",
+            "2014-02-03T01:23:45-23:59",
+            "2014-02-03T01:23:45-00:00",
+            "2014-02-03T24:00:00Z",
+        ]:
+            self.assertEqual(parse_datetime(timestamp), parse_prefix(timestamp)[0], timestamp)
+
+        # Offsets of 24 hours or more are only rejected if the time zone is kept
+        self.assertEqual(parse_datetime_as_naive("2014-02-03T01:23:45+24:00"), datetime.datetime(2014, 2, 3, 1, 23, 45))
+        self.assertRaises(ValueError, parse_datetime, "2014-02-03T01:23:45+24:00")
+        self.assertRaisesRegex(ValueError, r"tzminute must be in 0..59", parse_datetime_as_naive, "2014-02-03T01:23:45+05:60")
+
     def test_returns_built_in_utc_if_available(self):
         # Python 3.7 added a built-in UTC object at the C level (`PyDateTime_TimeZone_UTC`)
         # PyPy added support for it in 7.3.6, but only for PyPy 3.8+
@@ -533,6 +570,990 @@ class Rfc3339TestCase(unittest.TestCase):
                 parse_rfc3339(timestamp)
 
 
+class DateAndTimeTestCase(unittest.TestCase):
+    def test_parse_date_matches_parse_datetime(self):
+        count = 0
+        for timestamp, expected_datetime in generate_valid_timestamp_and_datetime():
+            if re.search(r"[Tt ]", timestamp) is None:
+                self.assertEqual(parse_date(timestamp), expected_datetime.date(), msg=timestamp)
+                count += 1
+        self.assertGreater(count, 0)
+
+    def test_parse_time_matches_parse_datetime(self):
+        count = 0
+        for timestamp, expected_datetime in generate_valid_timestamp_and_datetime():
+            match = re.match(r"[^Tt ]+[Tt ](.*)", timestamp)
+            if match is not None and not match.group(1).startswith("24"):
+                self.assertEqual(parse_time(match.group(1)), expected_datetime.timetz(), msg=timestamp)
+                self.assertEqual(parse_time("T" + match.group(1)), expected_datetime.timetz(), msg=timestamp)
+                count += 1
+        self.assertGreater(count, 0)
+
+    def test_parse_date(self):
+        self.assertEqual(parse_date("2024-03-15"), datetime.date(2024, 3, 15))
+        self.assertEqual(parse_date("2024-W11-5"), datetime.date(2024, 3, 15))
+        self.assertEqual(parse_date("2024075"), datetime.date(2024, 3, 15))
+        self.assertIs(type(parse_date("2024-03-15")), datetime.date)
+
+    def test_parse_time(self):
+        self.assertEqual(parse_time("10:35:27.123"), datetime.time(10, 35, 27, 123000))
+        self.assertEqual(parse_time("103527Z"), datetime.time(10, 35, 27, tzinfo=datetime.timezone.utc))
+        self.assertEqual(parse_time("T10:35+05:30"), datetime.time(10, 35, tzinfo=FixedOffset(330 * 60)))
+        self.assertEqual(parse_time("10"), datetime.time(10))
+
+    def test_invalid_date(self):
+        self.assertRaisesRegex(ValueError, r"unconverted data remains: 'T10:00'", parse_date, "2024-03-15T10:00")
+        self.assertRaisesRegex(ValueError, r"day is out of range for month", parse_date, "2024-02-30")
+        self.assertRaisesRegex(ValueError, r"Invalid character while parsing month", parse_date, "2024-3-15")
+        self.assertRaisesRegex(TypeError, r"argument must be str", parse_date, b"2024-03-15")
+
+    def test_invalid_time(self):
+        self.assertRaisesRegex(ValueError, r"hour must be in 0..23", parse_time, "24:00:00")
+        self.assertRaisesRegex(ValueError, r"minute must be in 0..59", parse_time, "10:61")
+        self.assertRaisesRegex(ValueError, r"unconverted data remains: ' junk'", parse_time, "10:35:27Z junk")
+        self.assertRaisesRegex(ValueError, r"Unexpected end of string while parsing hour", parse_time, "T")
+        self.assertRaises(ValueError, parse_time, "2024-03-15T10:35")
+        self.assertRaisesRegex(ValueError, r"Invalid character while parsing time separator", parse_time, "10:3527")
+
+
+class Rfc2822TestCase(unittest.TestCase):
+    def test_matches_email_utils(self):
+        for string in [
+            "Tue, 01 Jul 2003 10:52:37 +0200",
+            "Tue, 1 Jul 2003 10:52:37 +0200",
+            "1 Jul 2003 10:52:37 -0330",
+            "Tuesday, 01 Jul 2003 10:52:37 +0200",
+            "tue, 01 JUL 2003 10:52:37 +0200",
+            "  Tue,\t01  Jul 2003   10:52:37 +0200  ",
+            "Tue, 01 Jul 2003 10:52 +0200",
+            "Tue, 01 Jul 2003 10:52:37 -0000",  # Unknown offset, so naive
+            "Tue, 01 Jul 03 10:52:37 GMT",
+            "Tue, 01 Jul 69 10:52:37 UT",
+            "Tue, 01 Jul 2003 10:52:37 Z",
+            "Tue, 01 Jul 2003 10:52:37 est",
+            "Tue, 01 Jul 2003 10:52:37 PDT",
+        ]:
+            self.assertEqual(parse_rfc2822(string), email.utils.parsedate_to_datetime(string.strip()), msg=string)
+
+        self.assertEqual(parse_rfc2822("Tue, 01 Jul 03 10:52:37 GMT").year, 2003)
+        self.assertEqual(parse_rfc2822("Tue, 01 Jul 69 10:52:37 GMT").year, 1969)
+        # Three digit years are relative to 1900 (RFC 2822 section 4.3), unlike `email.utils`
+        self.assertEqual(parse_rfc2822("Tue, 01 Jul 103 10:52:37 GMT").year, 2003)
+        self.assertIsNone(parse_rfc2822("Tue, 01 Jul 2003 10:52:37 -0000").tzinfo)
+
+    def test_unknown_zones(self):
+        # Unknown zones (including the military ones other than Z) are treated as -0000 (RFC 5322 section 4.3), as by `email.utils`
+        for string in ["Tue, 01 Jul 2003 10:52:37 A", "Tue, 01 Jul 2003 10:52:37 z", "Tue, 01 Jul 2003 10:52:37 XYZ", "Tue, 01 Jul 2003 10:52:37 ABCDE "]:
+            self.assertEqual(parse_rfc2822(string), email.utils.parsedate_to_datetime(string.strip()), msg=string)
+        self.assertIsNone(parse_rfc2822("Tue, 01 Jul 2003 10:52:37 A").tzinfo)
+        self.assertIs(parse_rfc2822("Tue, 01 Jul 2003 10:52:37 Z").tzinfo, datetime.timezone.utc)
+        self.assertRaisesRegex(ValueError, r"unconverted data remains: '1'", parse_rfc2822, "Tue, 01 Jul 2003 10:52:37 XYZ1")
+
+    def test_round_trips_format_datetime(self):
+        for tzinfo in [datetime.timezone.utc, FixedOffset(330 * 60), FixedOffset(-8 * 3600)]:
+            dt = datetime.datetime(2014, 2, 3, 10, 35, 27, tzinfo=tzinfo)
+            self.assertEqual(parse_rfc2822(email.utils.format_datetime(dt)), dt)
+
+    def test_invalid(self):
+        for string, message in [
+            ("", r"Unexpected end of string while parsing day\."),
+            ("Tue 01 Jul 2003 10:52:37 GMT", r"day of week separator"),
+            ("Tux, 01 Jul 2003 10:52:37 GMT", r"day of week \('T', Index: 0\)"),
+            ("Tue, 01 Jux 2003 10:52:37 GMT", r"month \('J', Index: 8\)"),
+            ("Tue, 01 Jul 2003 10:52:37", r"Unexpected end of string while parsing time zone"),
+            ("Tue, 01 Jul 2003 10:52:37 ABCDEF", r"time zone \('A', Index: 26\)"),
+            ("Tue, 01 Jul 2003 10:52:37 1", r"time zone \('1', Index: 26\)"),
+            ("Tue, 01 Jul 2003 10:52:37 +0260", r"minute must be in 0..59"),
+            ("Tue, 01 Jul 2003 10:52:37 GMT junk", r"unconverted data remains: 'junk'"),
+            ("Tue, 31 Jun 2003 10:52:37 GMT", r"day is out of range for month"),
+            ("Tue, 01-Jul-2003 10:52:37 GMT", r"separator"),
+        ]:
+            self.assertRaisesRegex(ValueError, message, parse_rfc2822, string)
+        self.assertRaises(ValueError, parse_rfc2822, "Tue, 01 Jul 2003 10:52:37 +2400")
+
+    def test_cached_tzinfo(self):
+        self.assertIs(parse_rfc2822("Tue, 01 Jul 2003 10:52:37 GMT").tzinfo, datetime.timezone.utc)
+        tzinfos = [parse_rfc2822("Tue, 01 Jul 2003 10:52:37 -0500").tzinfo, parse_datetime("2003-07-01T10:52:37-05:00").tzinfo]
+        if tzinfos[0] is not tzinfos[1]:  # i.e., CISO8601_CACHING_ENABLED=0
+            self.skipTest("ciso8601 was built without CISO8601_CACHING_ENABLED=1")
+        self.assertIs(parse_rfc2822("Tue, 01 Jul 2003 10:52:37 EST").tzinfo, tzinfos[0])
+
+
+class HttpDateTestCase(unittest.TestCase):
+    def test_formats(self):
+        expected = datetime.datetime(1994, 11, 6, 8, 49, 37, tzinfo=datetime.timezone.utc)
+        for string in [
+            "Sun, 06 Nov 1994 08:49:37 GMT",  # IMF-fixdate
+            "sun, 06 nov 1994 08:49:37 GMT",
+            "Sunday, 06-Nov-94 08:49:37 GMT",  # RFC 850
+            "Sun Nov  6 08:49:37 1994",  # asctime()
+            "Sun, 6 Nov 1994 08:49:37 GMT",  # Not IMF-fixdate, but still accepted
+        ]:
+            self.assertEqual(parse_http_date(string), expected, msg=string)
+
+    def test_matches_format_datetime(self):
+        for dt in [
+            datetime.datetime(1970, 1, 1, tzinfo=datetime.timezone.utc),
+            datetime.datetime(2014, 2, 3, 10, 35, 27, tzinfo=datetime.timezone.utc),
+            datetime.datetime(9999, 12, 31, 23, 59, 59, tzinfo=datetime.timezone.utc),
+        ]:
+            self.assertEqual(parse_http_date(email.utils.format_datetime(dt, usegmt=True)), dt)
+
+    def test_invalid(self):
+        for string, message in [
+            ("06 Nov 1994 08:49:37 GMT", r"day of week \('0', Index: 0\)"),
+            ("Sun, 06 Nov 1994 08:49:37 +0000", r"HTTP dates must be in GMT"),
+            ("Sun, 06 Nov 1994 08:49:37 UTC", r"HTTP dates must be in GMT"),
+            ("Sun, 06 Nov 1994 08:49:37 GMX", r"time zone"),
+            ("Sun, 06 Nov 1994 08:49:3a GMT", r"second \('a', Index: 24\)"),
+            ("Sun, 06 Nov 1994 08:49:37 GMTx", r"time zone"),
+            ("Sun Nov  6 08:49:37", r"Unexpected end of string while parsing year"),
+            ("Sunday, 06 Nov 1994 08:49:37 GMT", r"date separator \('-'\)"),
+        ]:
+            self.assertRaisesRegex(ValueError, message, parse_http_date, string)
+
+
+class PrefixTestCase(unittest.TestCase):
+    def test_auto_generated_valid_formats_followed_by_text(self):
+        for (timestamp, expected_datetime) in generate_valid_timestamp_and_datetime():
+            for line in (timestamp, timestamp + " INFO message", timestamp + "|x"):
+                try:
+                    self.assertEqual(parse_prefix(line), (expected_datetime, len(timestamp)))
+                except Exception:
+                    print("Had problems parsing: {line}".format(line=line))
+                    raise
+
+    def test_stops_at_longest_valid_timestamp(self):
+        for line, expected_datetime, expected_end in [
+            ("2024-01-15 INFO", datetime.datetime(2024, 1, 15), 10),
+            ("2024-03-1x", datetime.datetime(2024, 3, 1), 7),
+            ("2024-031 rest", datetime.datetime(2024, 1, 31), 8),
+            ("2024W115x", datetime.datetime(2024, 3, 15), 8),
+            ("2024-W11 x", datetime.datetime(2024, 3, 11), 8),
+            ("2024-01-15T10:00:00.x", datetime.datetime(2024, 1, 15, 10), 19),
+            ("2024-01-15T10:00:00-foo", datetime.datetime(2024, 1, 15, 10), 19),
+            ("2024-01-15T10:00:00+05:x", datetime.datetime(2024, 1, 15, 10, tzinfo=FixedOffset(5 * 3600)), 22),
+            ("2024-01-15T101500", datetime.datetime(2024, 1, 15, 10), 13),
+            ("20240115T10:15:00", datetime.datetime(2024, 1, 15, 10), 11),
+        ]:
+            self.assertEqual(parse_prefix(line), (expected_datetime, expected_end), line)
+
+    def test_pos_and_endpos(self):
+        line = "[2014-02-03T10:35:27Z] GET /"
+        expected_datetime = datetime.datetime(2014, 2, 3, 10, 35, 27, tzinfo=datetime.timezone.utc)
+        self.assertEqual(parse_prefix(line, 1), (expected_datetime, 21))
+        self.assertEqual(parse_prefix(line, pos=1, endpos=20), (expected_datetime.replace(tzinfo=None), 20))
+        self.assertEqual(parse_prefix(line, 1, 17), (datetime.datetime(2014, 2, 3, 10, 35), 17))
+        self.assertRaises(ValueError, parse_prefix, line, 0)
+        self.assertRaises(ValueError, parse_prefix, line, 1, 5)
+        self.assertRaises(ValueError, parse_prefix, line, 100)
+
+    def test_non_ascii_str_uses_code_point_indices(self):
+        line = "éé 2014-02-03 ✓"
+        self.assertEqual(parse_prefix(line, 3), (datetime.datetime(2014, 2, 3), 13))
+        self.assertEqual(parse_prefix(line, 3, 10), (datetime.datetime(2014, 2, 1), 10))
+
+    def test_bytes_like_input(self):
+        expected = (datetime.datetime(2014, 2, 3, 10, 35, 27), 20)
+        self.assertEqual(parse_prefix(b" 2014-02-03T10:35:27 x", 1), expected)
+        self.assertEqual(parse_prefix(bytearray(b" 2014-02-03T10:35:27 x"), 1), expected)
+        self.assertEqual(parse_prefix(memoryview(b" 2014-02-03T10:35:27 x"), 1), expected)
+        self.assertRaisesRegex(
+            ValueError,
+            r"Invalid character while parsing year \('\ufffd', Index: 0\)",
+            parse_prefix,
+            b"\xff2014",
+        )
+
+    def test_invalid_arguments(self):
+        self.assertRaises(TypeError, parse_prefix, 20140203)
+        self.assertRaisesRegex(ValueError, r"month must be in 1..12", parse_prefix, "2014-13-01 x")
+        self.assertRaisesRegex(
+            ValueError,
+            r"Unexpected end of string while parsing month. Expected 2 more characters",
+            parse_prefix,
+            "2014-",
+        )
+
+
+class BucketTestCase(unittest.TestCase):
+    EPOCH = datetime.datetime(1970, 1, 1, tzinfo=datetime.timezone.utc)
+
+    def expected_bucket(self, dt, unit):
+        if dt.tzinfo is None:
+            dt = dt.replace(tzinfo=datetime.timezone.utc)
+        dt = dt.astimezone(datetime.timezone.utc)
+        if unit == "week":
+            dt = dt - datetime.timedelta(days=dt.weekday())
+            dt = dt.replace(hour=0, minute=0, second=0, microsecond=0)
+        elif unit == "month":
+            dt = dt.replace(day=1, hour=0, minute=0, second=0, microsecond=0)
+        seconds = (dt - self.EPOCH) // datetime.timedelta(seconds=1)
+        size = {"week": 1, "month": 1, "minute": 60, "hour": 3600, "day": 86400}.get(unit, unit)
+        return seconds // size * size
+
+    def test_auto_generated_valid_formats(self):
+        for (timestamp, expected_datetime) in generate_valid_timestamp_and_datetime():
+            for unit in ("minute", "hour", "day", "week", "month", 1, 900):
+                try:
+                    self.assertEqual(parse_bucket(timestamp, unit), self.expected_bucket(expected_datetime, unit))
+                except Exception:
+                    print("Had problems parsing: {timestamp} ({unit})".format(timestamp=timestamp, unit=unit))
+                    raise
+
+    def test_buckets_are_in_utc(self):
+        self.assertEqual(parse_bucket("2014-02-03T00:30:00+01:00", "day"), parse_bucket("2014-02-02", "day"))
+        self.assertEqual(parse_bucket("2014-03-01T00:30:00+01:00", "month"), parse_bucket("2014-02-01", "month"))
+        # 2014-02-03 is a Monday
+        self.assertEqual(parse_bucket("2014-02-03T00:30:00+01:00", "week"), parse_bucket("2014-01-27", "week"))
+        self.assertEqual(parse_bucket("2014-02-09T23:59:59Z", "week"), parse_bucket("2014-02-03", "week"))
+
+    def test_special_midnight(self):
+        self.assertEqual(parse_bucket("2014-02-03T24:00:00", "day"), parse_bucket("2014-02-04", "day"))
+
+    def test_before_epoch(self):
+        self.assertEqual(parse_bucket("1969-12-31T23:59:59", "hour"), -3600)
+        self.assertEqual(parse_bucket("0001-01-01", "day"), -62135596800)
+
+    def test_as_datetime(self):
+        self.assertEqual(
+            parse_bucket("2014-02-05T10:35:27.123456", "week", as_datetime=True),
+            datetime.datetime(2014, 2, 3),
+        )
+        self.assertEqual(
+            parse_bucket("2014-02-05T10:35:27-05:30", "hour", as_datetime=True),
+            datetime.datetime(2014, 2, 5, 16, tzinfo=datetime.timezone.utc),
+        )
+        self.assertRaisesRegex(OverflowError, r"date value out of range", parse_bucket, "0001-01-01T00:00+01:00", "day", True)
+
+    def test_many(self):
+        timestamps = ["2014-02-03T10:35:27Z", "2014-02-03T10:59:59+00:00", "2014-02-03T11:00:00"]
+        self.assertEqual(parse_bucket_many(timestamps, "hour"), [1391421600, 1391421600, 1391425200])
+        self.assertEqual(parse_bucket_many(iter(timestamps), unit="hour"), [1391421600, 1391421600, 1391425200])
+        self.assertEqual(
+            parse_bucket_many(timestamps, "day", as_datetime=True),
+            [datetime.datetime(2014, 2, 3, tzinfo=datetime.timezone.utc)] * 2 + [datetime.datetime(2014, 2, 3)],
+        )
+        self.assertEqual(parse_bucket_many([], "hour"), [])
+        self.assertRaisesRegex(ValueError, r"month must be in 1..12", parse_bucket_many, timestamps + ["2014-13-01"], "hour")
+
+    def test_invalid_timestamps(self):
+        for timestamp, reason in generate_invalid_timestamp():
+            with self.assertRaises(ValueError, msg="Timestamp '{0}' was supposed to be invalid ({1}), but parsing it didn't raise ValueError.".format(timestamp, reason)):
+                parse_bucket(timestamp, "hour")
+        self.assertRaisesRegex(ValueError, r"day is out of range for month", parse_bucket, "2014-02-29", "day")
+        self.assertRaisesRegex(ValueError, r"hour must be in 0..23", parse_bucket, "2014-02-03T24:35:27", "day")
+        self.assertRaises(TypeError, parse_bucket, b"2014-02-03", "day")
+
+    def test_out_of_range(self):
+        # As with parse_datetime, 24:00 on 9999-12-31 (i.e., 10000-01-01) isn't representable
+        for unit in ("hour", "day", "week", "month", 900):
+            self.assertRaisesRegex(OverflowError, r"date value out of range", parse_bucket, "9999-12-31T24:00", unit)
+        self.assertRaisesRegex(OverflowError, r"date value out of range", parse_bucket_many, ["9999-12-31T24:00"], "hour")
+        self.assertEqual(parse_bucket("9999-12-31T23:59:59", "hour"), 253402297200)
+
+    def test_invalid_units(self):
+        for unit in ("fortnight", "Hour", 0, -60, 1.5, None, True, False):
+            self.assertRaisesRegex(ValueError, r"unit must be one of", parse_bucket, "2014-02-03", unit)
+        self.assertRaisesRegex(ValueError, r"unit must be one of .* not True", parse_bucket_many, ["2014-02-03"], True)
+
+    def test_many_out(self):
+        timestamps = ["2014-02-03T10:35:27Z", "2014-13-01", "2014-02-03T11:00:00"]
+        out = array.array("q", [0] * 5)
+        self.assertEqual(parse_bucket_many(timestamps, "hour", out=out, offset=1), (2, [1]))
+        self.assertEqual(out.tolist(), [0, 1391421600, -2 ** 63, 1391425200, 0])
+        # The start of the month would be before 0001-01-01
+        self.assertEqual(parse_bucket_many(timestamps[:1] + ["0001-01-01T00:00+01:00"], "month", out=out), (1, [1]))
+        self.assertEqual(out[:2].tolist(), [1391212800, -2 ** 63])
+        self.assertRaisesRegex(ValueError, r"as_datetime can't be used with out", parse_bucket_many, timestamps, "hour", True, out=out)
+
+
+class EpochManyTestCase(unittest.TestCase):
+    EPOCH = datetime.datetime(1970, 1, 1, tzinfo=datetime.timezone.utc)
+
+    def test_auto_generated_valid_formats(self):
+        timestamps, expected = [], []
+        for (timestamp, expected_datetime) in generate_valid_timestamp_and_datetime():
+            if expected_datetime.tzinfo is None:
+                expected_datetime = expected_datetime.replace(tzinfo=datetime.timezone.utc)
+            timestamps.append(timestamp)
+            expected.append((expected_datetime - self.EPOCH) // datetime.timedelta(microseconds=1))
+
+        out = array.array("q", [0] * len(timestamps))
+        self.assertEqual(parse_epoch_many(timestamps, out), (len(timestamps), []))
+        self.assertEqual(out.tolist(), expected)
+
+    def test_invalid_timestamps_are_reported(self):
+        timestamps = [timestamp for timestamp, _reason in generate_invalid_timestamp()]
+        out = array.array("q", [0] * (len(timestamps) + 1))
+        self.assertEqual(parse_epoch_many(timestamps + ["1970-01-01T00:00:01Z"], out), (1, list(range(len(timestamps)))))
+        self.assertEqual(out.tolist(), [-2 ** 63] * len(timestamps) + [1000000])
+
+    def test_offset(self):
+        out = memoryview(bytearray(8 * 4)).cast("q")
+        self.assertEqual(parse_epoch_many(iter(["1970-01-01T00:00:00.000001", "2014-02-30"]), out, offset=2), (1, [1]))
+        self.assertEqual(out.tolist(), [0, 0, 1, -2 ** 63])
+        self.assertEqual(parse_epoch_many([], out, 4), (0, []))
+
+    def test_invalid_out(self):
+        self.assertRaisesRegex(TypeError, r"64-bit signed integers", parse_epoch_many, ["1970-01-01"], array.array("i", [0]))
+        self.assertRaisesRegex(TypeError, r"64-bit signed integers", parse_epoch_many, ["1970-01-01"], array.array("d", [0]))
+        self.assertRaises(BufferError, parse_epoch_many, ["1970-01-01"], bytes(8))
+        self.assertRaises(TypeError, parse_epoch_many, ["1970-01-01"], None)
+        for offset in (-1, 1):
+            self.assertRaisesRegex(ValueError, r"out has room for 1 values", parse_epoch_many, ["1970-01-01"], array.array("q", [0]), offset)
+        self.assertRaisesRegex(TypeError, r"argument must be str", parse_epoch_many, [b"1970-01-01"], array.array("q", [0]))
+
+    def test_out_of_range(self):
+        # As with parse_datetime, 24:00 on 9999-12-31 (i.e., 10000-01-01) isn't representable
+        timestamps = ["9999-12-31T24:00", "9999-12-31T23:59:59.999999", "9999-12-31T24:00"]
+        out = array.array("q", [0] * 3)
+        self.assertEqual(parse_epoch_many(timestamps, out), (1, [0, 2]))
+        self.assertEqual(out.tolist(), [-2 ** 63, 253402300799999999, -2 ** 63])
+        self.assertEqual(parse_epoch_many(timestamps, out, dedupe=True), (1, [0, 2], 2))
+        self.assertEqual(out.tolist(), [-2 ** 63, 253402300799999999, -2 ** 63])
+        self.assertEqual(parse_bucket_many(timestamps, "hour", out=out), (1, [0, 2]))
+        self.assertEqual(out.tolist(), [-2 ** 63, 253402297200, -2 ** 63])
+        self.assertEqual(parse_delimited_column("\n".join(timestamps).encode("utf-8"), 0, out=out), (1, [0, 2]))
+        self.assertEqual(out.tolist(), [-2 ** 63, 253402300799999999, -2 ** 63])
+
+
+class DelimitedColumnTestCase(unittest.TestCase):
+    def test_matches_csv_reader(self):
+        rows = []
+        for i, (timestamp, _expected_datetime) in enumerate(generate_valid_timestamp_and_datetime()):
+            rows.append([str(i), "a, \"quoted\" field", "multi\nline", timestamp, ""])
+        for lineterminator in ("\r\n", "\n"):
+            text = io.StringIO()
+            csv.writer(text, lineterminator=lineterminator).writerows(rows)
+            expected = [parse_datetime(row[3]) for row in csv.reader(io.StringIO(text.getvalue()))]
+            self.assertEqual(parse_delimited_column(text.getvalue().encode("utf-8")), expected)
+
+    def test_quoting_and_line_endings(self):
+        data = b'1,"a, b",x,"2014-02-03T10:35:27Z"\r\n\r\n2,"c\r\nd",y,2014-02-03\r3,e,z,2014-02-04T00:00:00.5'
+        self.assertEqual(parse_delimited_column(bytearray(data)), [
+            datetime.datetime(2014, 2, 3, 10, 35, 27, tzinfo=datetime.timezone.utc),
+            datetime.datetime(2014, 2, 3),
+            datetime.datetime(2014, 2, 4, 0, 0, 0, 500000),
+        ])
+        self.assertEqual(parse_delimited_column(memoryview(b"2014-02-03|x\n"), column=0, delimiter=b"|", quotechar=None), [datetime.datetime(2014, 2, 3)])
+        self.assertEqual(parse_delimited_column(b"'2014-02-03';x", 0, b";", b"'"), [datetime.datetime(2014, 2, 3)])
+        self.assertEqual(parse_delimited_column(b""), [])
+
+    def test_out(self):
+        data = b"id,a,b,created\n1,a,b,1970-01-01T00:00:01Z\n2,a,b\n3,a,b,1970-01-01T00:00:00.000002\n"
+        out = array.array("q", [0] * 5)
+        self.assertEqual(parse_delimited_column(data, out=out, offset=1), (2, [0, 2]))
+        self.assertEqual(out.tolist(), [0, -2 ** 63, 1000000, -2 ** 63, 2])
+        self.assertRaisesRegex(ValueError, r"out has room for 3 values", parse_delimited_column, data, out=out, offset=2)
+
+    def test_header_row(self):
+        rows = [["id", "name", "note", "created"], ["1", "Smith, J", "a\nb", "2014-02-03T10:35:27Z"], ["2", "Doe, J", "", "2014-02-04"]]
+        text = io.StringIO()
+        csv.writer(text).writerows(rows)
+        data = text.getvalue().encode("utf-8")
+        expected = [parse_datetime("2014-02-03T10:35:27Z"), parse_datetime("2014-02-04")]
+        self.assertEqual(parse_delimited_column(data, skip_rows=1), expected)
+        self.assertRaisesRegex(ValueError, r"Record 0: Invalid character", parse_delimited_column, data)
+
+        # A quoted line break in the header doesn't end it, and blank lines aren't counted
+        self.assertEqual(parse_delimited_column(b'\n"multi\nline",created\n\n1,2014-02-03\n', 1, skip_rows=1), [datetime.datetime(2014, 2, 3)])
+        self.assertEqual(parse_delimited_column(data, skip_rows=3), [])
+        self.assertEqual(parse_delimited_column(data, skip_rows=5), [])
+
+        out = array.array("q", [0] * 2)
+        self.assertEqual(parse_delimited_column(data, out=out, skip_rows=1), (2, []))
+        self.assertEqual(out.tolist(), [1391423727000000, 1391472000000000])
+        self.assertEqual(parse_delimited_column(data, dedupe=True, skip_rows=1), (expected, 2))
+        self.assertRaisesRegex(ValueError, r"skip_rows must not be negative", parse_delimited_column, data, skip_rows=-1)
+
+    def test_invalid(self):
+        self.assertRaisesRegex(ValueError, r"Record 1: Invalid character while parsing year \('x', Index: 0\)", parse_delimited_column, b"1,a,b,2014-02-03\n2,a,b,x")
+        self.assertRaisesRegex(ValueError, r"Record 0: day is out of range for month", parse_delimited_column, b"1,a,b,2014-02-30")
+        self.assertRaisesRegex(ValueError, r"Record 1 has no column 3", parse_delimited_column, b"1,a,b,2014-02-03\n2,a,b")
+        self.assertRaisesRegex(ValueError, r"Record 0: Invalid character", parse_delimited_column, b'1,a,b,"2014-02-03"junk', quotechar=None)
+        self.assertRaisesRegex(ValueError, r"column must not be negative", parse_delimited_column, b"", column=-1)
+        self.assertRaisesRegex(ValueError, r"delimiter must not be", parse_delimited_column, b"", delimiter=b"\n")
+        self.assertRaisesRegex(TypeError, r"quotechar must be", parse_delimited_column, b"", quotechar="'")
+        self.assertRaises(TypeError, parse_delimited_column, "1,a,b,2014-02-03")
+
+
+class TimestampTestCase(unittest.TestCase):
+    def test_auto_generated_valid_formats(self):
+        for (timestamp, expected_datetime) in generate_valid_timestamp_and_datetime():
+            try:
+                self.assertEqual(parse_timestamp_obj(timestamp).to_datetime(), expected_datetime)
+            except Exception:
+                print("Had problems parsing: {timestamp}".format(timestamp=timestamp))
+                raise
+
+    def test_invalid_timestamps(self):
+        for timestamp, reason in generate_invalid_timestamp():
+            with self.assertRaises(ValueError, msg="Timestamp '{0}' was supposed to be invalid ({1}), but parsing it didn't raise ValueError.".format(timestamp, reason)):
+                parse_timestamp_obj(timestamp)
+        self.assertRaisesRegex(ValueError, r"day is out of range for month", parse_timestamp_obj, "2014-02-29")
+        self.assertRaisesRegex(OverflowError, r"date value out of range", parse_timestamp_obj, "9999-12-31T24:00:00")
+        self.assertRaises(TypeError, parse_timestamp_obj, b"2014-02-03")
+        self.assertRaises(TypeError, Timestamp)
+
+    def test_to_datetime(self):
+        self.assertEqual(parse_timestamp_obj("2014-02-03T24:00:00").to_datetime(), datetime.datetime(2014, 2, 4))
+        self.assertEqual(parse_timestamp_obj("1969-12-31T23:59:59.5").to_datetime(), datetime.datetime(1969, 12, 31, 23, 59, 59, 500000))
+        self.assertEqual(
+            parse_timestamp_obj("0001-01-01T00:00:00+05:00").to_datetime(),
+            datetime.datetime(1, 1, 1, tzinfo=FixedOffset(5 * 3600)),
+        )
+        self.assertIs(parse_timestamp_obj("2014-02-03T10:35:27Z").to_datetime().tzinfo, parse_datetime("2014-02-03T10:35:27Z").tzinfo)
+
+    def test_attributes(self):
+        timestamp = parse_timestamp_obj("2014-02-03T10:35:27.123456-05:30")
+        self.assertEqual(timestamp.epoch_microseconds, 1391443527123456)
+        self.assertEqual(timestamp.utcoffset_minutes, -330)
+        self.assertEqual(timestamp.timestamp(), parse_datetime("2014-02-03T10:35:27.123456-05:30").timestamp())
+        self.assertIsNone(parse_timestamp_obj("2014-02-03T10:35:27").utcoffset_minutes)
+        self.assertEqual(parse_timestamp_obj("1970-01-01T00:00:01.5").timestamp(), 1.5)
+        self.assertEqual(repr(timestamp), "ciso8601.Timestamp('2014-02-03T10:35:27.123456-05:30')")
+
+    def test_comparisons_and_hashing(self):
+        a = parse_timestamp_obj("2014-02-03T10:35:27+01:00")
+        b = parse_timestamp_obj("2014-02-03T09:35:27Z")
+        c = parse_timestamp_obj("2014-02-03T09:35:27.000001Z")
+        self.assertEqual(a, b)
+        self.assertEqual(hash(a), hash(b))
+        self.assertEqual(len({a, b, c}), 2)
+        self.assertTrue(a < c and c > b and a <= b and a >= b and a != c)
+        self.assertEqual(sorted([c, a]), [a, c])
+        self.assertNotEqual(a, a.to_datetime())
+
+        naive = parse_timestamp_obj("2014-02-03T09:35:27")
+        self.assertLess(naive, parse_timestamp_obj("2014-02-03T09:35:28"))
+        self.assertNotEqual(naive, b)
+        self.assertRaisesRegex(TypeError, r"can't compare offset-naive and offset-aware timestamps", lambda: naive < b)
+
+    def test_subtraction(self):
+        a = parse_timestamp_obj("2014-02-03T10:35:27.5+01:00")
+        b = parse_timestamp_obj("2014-02-01T00:00:00Z")
+        self.assertEqual(a - b, a.to_datetime() - b.to_datetime())
+        self.assertEqual(b - a, b.to_datetime() - a.to_datetime())
+        self.assertEqual(parse_timestamp_obj("2014-02-03") - parse_timestamp_obj("2014-02-02T12:00"), datetime.timedelta(hours=12))
+        self.assertRaisesRegex(TypeError, r"can't subtract offset-naive and offset-aware timestamps", lambda: parse_timestamp_obj("2014-02-03") - b)
+        self.assertRaises(TypeError, lambda: a - datetime.timedelta(days=1))
+
+
+class SortAndSearchTestCase(unittest.TestCase):
+    @staticmethod
+    def instant(dt):
+        return dt if dt.tzinfo is not None else dt.replace(tzinfo=datetime.timezone.utc)
+
+    def test_argsort_auto_generated_valid_formats(self):
+        pairs = list(generate_valid_timestamp_and_datetime())
+        expected = sorted(range(len(pairs)), key=lambda i: self.instant(pairs[i][1]))
+        self.assertEqual(argsort_timestamps([timestamp for timestamp, _ in pairs]), expected)
+
+    def test_argsort_is_stable(self):
+        timestamps = ["2014-01-01T00:00:00Z", "2014-01-01T01:00:00+01:00", "2013-12-31T23:00", "2014-01-01", "0001-01-01", "9999-12-31T24:00:00"]
+        self.assertEqual(argsort_timestamps(timestamps), [4, 2, 0, 1, 3, 5])
+        self.assertEqual(argsort_timestamps(iter(timestamps)), [4, 2, 0, 1, 3, 5])
+        self.assertEqual(argsort_timestamps([]), [])
+        self.assertRaisesRegex(ValueError, r"Invalid character while parsing year", argsort_timestamps, timestamps + ["junk"])
+
+    def test_bisect(self):
+        timestamps = ["2014-01-01T00:00:00Z", "2014-01-01T01:00:00+01:00", "2014-01-01T00:00:00.000001", "2014-01-02"]
+        instants = [self.instant(parse_datetime(timestamp)) for timestamp in timestamps]
+        for instant in instants + [instants[0] - datetime.timedelta(microseconds=1), instants[-1] + datetime.timedelta(days=1)]:
+            for side, function in (("left", bisect.bisect_left), ("right", bisect.bisect_right)):
+                expected = function(instants, instant)
+                self.assertEqual(bisect_timestamps(timestamps, instant, side=side), expected)
+                self.assertEqual(bisect_timestamps(timestamps, instant.isoformat(), side=side), expected)
+                self.assertEqual(bisect_timestamps(timestamps, parse_timestamp_obj(instant.isoformat()), side=side), expected)
+                self.assertEqual(bisect_timestamps(tuple(timestamps), instant, 1, 3, side=side), function(instants, instant, 1, 3))
+
+        self.assertEqual(bisect_timestamps(timestamps, datetime.datetime(2014, 1, 1)), 0)
+        self.assertEqual(bisect_timestamps([], "2014-01-01"), 0)
+
+    def test_bisect_only_parses_probed_strings(self):
+        # Searching for a later instant only probes indexes 3, 5 and 6
+        timestamps = ["junk", "junk", "junk", "2014-01-01", "junk", "2014-01-02", "2014-01-03"]
+        self.assertEqual(bisect_timestamps(timestamps, "2014-01-04"), 7)
+
+    def test_bisect_invalid(self):
+        self.assertRaisesRegex(ValueError, r"side must be 'left' or 'right'", bisect_timestamps, [], "2014-01-01", side="middle")
+        self.assertRaisesRegex(ValueError, r"lo must be non-negative", bisect_timestamps, [], "2014-01-01", -1)
+        self.assertRaisesRegex(TypeError, r"argument must be str", bisect_timestamps, [], 1388534400)
+        self.assertRaisesRegex(ValueError, r"Invalid character", bisect_timestamps, ["junk"], "2014-01-01")
+
+
+class TimestampStatsTestCase(unittest.TestCase):
+    def test_auto_generated_valid_formats(self):
+        pairs = list(generate_valid_timestamp_and_datetime())
+        timestamps = [timestamp for timestamp, _ in pairs]
+        instants = [dt if dt.tzinfo is not None else dt.replace(tzinfo=datetime.timezone.utc) for _, dt in pairs]
+        result = timestamp_stats(timestamps, bucket="hour")
+
+        self.assertIsInstance(result, TimestampStats)
+        self.assertEqual(result.count, len(timestamps))
+        self.assertEqual(result.errors, 0)
+        self.assertEqual(result.min, parse_timestamp_obj(timestamps[instants.index(min(instants))]))
+        self.assertEqual(result.max, parse_timestamp_obj(timestamps[instants.index(max(instants))]))
+        self.assertEqual(result.monotonic, instants == sorted(instants))
+
+        expected = {}
+        for timestamp in timestamps:
+            bucket = parse_bucket(timestamp, "hour")
+            expected[bucket] = expected.get(bucket, 0) + 1
+        self.assertEqual(result.histogram, expected)
+
+    def test_aggregates(self):
+        timestamps = ["2014-01-01T00:30:00Z", "2014-01-01T00:45:00", "junk", "2014-01-01T02:10:00+01:00", "2014-01-01T02:00:00Z", "2014-01-01T00:59:00Z"]
+        count, errors, earliest, latest, monotonic, histogram = timestamp_stats(timestamps, "hour")
+        self.assertEqual((count, errors, monotonic), (5, 1, False))
+        self.assertEqual(earliest.to_datetime(), datetime.datetime(2014, 1, 1, 0, 30, tzinfo=datetime.timezone.utc))
+        self.assertEqual(latest.to_datetime(), datetime.datetime(2014, 1, 1, 2, 0, tzinfo=datetime.timezone.utc))
+        self.assertEqual(histogram, {1388534400: 3, 1388538000: 1, 1388541600: 1})
+
+        result = timestamp_stats(iter(timestamps[:2] + timestamps[4:5]))
+        self.assertEqual((result.count, result.errors, result.monotonic, result.histogram), (3, 0, True, None))
+
+    def test_buffer(self):
+        timestamps = ["2014-01-01T00:30:00Z", "2014-01-01T00:45:00", "junk", "2014-02-01"]
+        result = timestamp_stats(timestamps, bucket="month")
+        for buffer in (b"\n".join(t.encode() for t in timestamps), b"\r\n".join(t.encode() for t in timestamps) + b"\r\n\n", bytearray(b"\n".join(t.encode() for t in timestamps))):
+            self.assertEqual(timestamp_stats(buffer, bucket="month"), result)
+        self.assertEqual(result.histogram, {1388534400: 2, 1391212800: 1})
+
+    def test_empty(self):
+        self.assertEqual(tuple(timestamp_stats([], bucket="day")), (0, 0, None, None, True, {}))
+        self.assertEqual(tuple(timestamp_stats(b"\n\n")), (0, 0, None, None, True, None))
+        self.assertEqual(timestamp_stats(["junk", ""]).errors, 2)
+
+    def test_invalid_arguments(self):
+        self.assertRaisesRegex(TypeError, r"not str", timestamp_stats, "2014-01-01")
+        self.assertRaises(TypeError, timestamp_stats, 1)
+        self.assertRaises(TypeError, timestamp_stats, ["2014-01-01", 1])
+        self.assertRaisesRegex(ValueError, r"unit must be one of", timestamp_stats, [], bucket="year")
+
+
+def tzif(footer, types=((0, 0),), transitions=()):
+    """Builds a version 2 TZif file, with an empty version 1 data block."""
+    counts = struct.pack(">6l", 0, 0, 0, len(transitions), len(types), 4)
+    data = b"".join(struct.pack(">q", time) for time, _ in transitions)
+    data += bytes(index for _, index in transitions)
+    data += b"".join(struct.pack(">lBB", offset, isdst, 0) for offset, isdst in types) + b"XXX\0"
+    v1 = b"TZif2" + bytes(15) + struct.pack(">6l", 0, 0, 0, 0, 1, 1) + bytes(7)
+    return v1 + b"TZif2" + bytes(15) + counts + data + b"\n" + footer + b"\n"
+
+
+@unittest.skipIf(zoneinfo is None, "zoneinfo (Python 3.9+) is needed to compare against")
+class AssumeTzTestCase(unittest.TestCase):
+    def zone(self, key):
+        try:
+            return zoneinfo.ZoneInfo(key)
+        except zoneinfo.ZoneInfoNotFoundError:
+            self.skipTest("The time zone database doesn't have {0}".format(key))
+
+    def assertLocalized(self, timestamp, key, fold=0, **kwargs):
+        naive = parse_datetime(timestamp)
+        expected = naive.replace(tzinfo=self.zone(key), fold=fold).astimezone(datetime.timezone.utc)
+        result = parse_datetime(timestamp, assume_tz=key, **kwargs)
+        self.assertEqual(result, expected)
+        self.assertEqual(result.utcoffset(), expected.astimezone(self.zone(key)).utcoffset())
+
+        out = array.array("q", [0])
+        self.assertEqual(parse_epoch_many([timestamp], out, assume_tz=key, **kwargs), (1, []))
+        self.assertEqual(out[0], (expected - datetime.datetime(1970, 1, 1, tzinfo=datetime.timezone.utc)) // datetime.timedelta(microseconds=1))
+        return result
+
+    def test_auto_generated_valid_formats(self):
+        for timestamp, expected in generate_valid_timestamp_and_datetime():
+            if expected.tzinfo is None and 1900 <= expected.year < 2100:
+                with self.subTest(timestamp=timestamp):
+                    self.assertLocalized(timestamp, "America/New_York")
+
+    def test_across_zones_and_years(self):
+        for key in ("America/New_York", "Europe/London", "Australia/Lord_Howe", "Asia/Kolkata", "America/Sao_Paulo", "Africa/Casablanca", "Pacific/Apia", "UTC"):
+            for year in (1800, 1950, 1985, 2024, 2038, 2100, 2500):
+                for month in range(1, 13):
+                    for hour in (0, 1, 2, 3, 12):
+                        timestamp = "{0:04}-{1:02}-{2:02}T{3:02}:30:00.5".format(year, month, 1 + month * 2, hour)
+                        with self.subTest(key=key, timestamp=timestamp):
+                            self.assertLocalized(timestamp, key)
+                            self.assertLocalized(timestamp, key, 1, ambiguous="later", nonexistent="shift_backward")
+
+    def test_ambiguous(self):
+        timestamp = "2024-11-03T01:30:00"
+        self.assertEqual(str(self.assertLocalized(timestamp, "America/New_York")), "2024-11-03 01:30:00-04:00")
+        self.assertEqual(str(self.assertLocalized(timestamp, "America/New_York", 1, ambiguous="later")), "2024-11-03 01:30:00-05:00")
+        self.assertRaisesRegex(ValueError, r"'2024-11-03T01:30:00' is an ambiguous local time in America/New_York", parse_datetime, timestamp, assume_tz="America/New_York", ambiguous="raise")
+
+        out = array.array("q", [0, 0])
+        self.assertEqual(parse_epoch_many([timestamp, "2024-11-03T02:30:00"], out, assume_tz="America/New_York", ambiguous="raise"), (1, [0]))
+        self.assertEqual(out[0], -(2 ** 63))
+
+    def test_nonexistent(self):
+        timestamp = "2024-03-10T02:30:00"
+        self.assertEqual(str(self.assertLocalized(timestamp, "America/New_York")), "2024-03-10 03:30:00-04:00")
+        self.assertEqual(str(self.assertLocalized(timestamp, "America/New_York", 1, nonexistent="shift_backward")), "2024-03-10 01:30:00-05:00")
+        self.assertRaisesRegex(ValueError, r"'2024-03-10T02:30:00' is a nonexistent local time in America/New_York", parse_datetime, timestamp, assume_tz="America/New_York", nonexistent="raise")
+        # Only the policy for the kind of local time applies
+        parse_datetime(timestamp, assume_tz="America/New_York", ambiguous="raise")
+
+    def test_aware_timestamps_are_unchanged(self):
+        for timestamp in ("2024-03-10T02:30:00Z", "2024-11-03T01:30:00-07:00"):
+            self.assertEqual(parse_datetime(timestamp, assume_tz="America/New_York", ambiguous="raise", nonexistent="raise"), parse_datetime(timestamp))
+        self.assertEqual(parse_datetime("2024-11-03T01:30:00", assume_tz=None), datetime.datetime(2024, 11, 3, 1, 30))
+
+    def test_offsets_with_seconds(self):
+        # Local mean time, before standard time was adopted
+        result = self.assertLocalized("1850-01-01T00:00:00", "America/New_York")
+        self.assertEqual(result.utcoffset(), -datetime.timedelta(hours=4, minutes=56, seconds=2))
+
+    @unittest.skipIf(platform.python_implementation() == "PyPy", "PyPy doesn't cache the tzinfos")
+    def test_cached_tzinfo(self):
+        if parse_datetime("2014-01-01T00:00:00-05:00").tzinfo is not parse_datetime("2015-01-01T00:00:00-05:00").tzinfo:
+            self.skipTest("ciso8601 was built with CISO8601_CACHING_ENABLED=0")
+        self.assertIs(parse_datetime("2024-01-01", assume_tz="America/New_York").tzinfo, parse_datetime("2014-01-01T00:00:00-05:00").tzinfo)
+
+    def test_rule_after_the_transitions(self):
+        # A "slim" file, where only the POSIX TZ string says when DST is, with a DST offset that isn't whole hours
+        # and a rule for the last Sunday of the month
+        with tempfile.TemporaryDirectory() as directory:
+            with open(os.path.join(directory, "Test_Slim"), "wb") as f:
+                f.write(tzif(b"<+0130>-1:30<+0215>-2:15,M3.5.0,M10.5.0/3", types=((3600, 0), (5400, 0)), transitions=((0, 1),)))
+            with open(os.path.join(directory, "Test_Invalid"), "wb") as f:
+                f.write(b"TZif2" + bytes(100))
+
+            zoneinfo.reset_tzpath([directory])
+            self.addCleanup(zoneinfo.reset_tzpath)
+            for timestamp in ("1969-12-31T23:00:00", "1970-01-01T00:00:00", "1970-01-01T02:00:00", "2024-03-31T01:45:00",
+                              "2024-03-31T02:00:00", "2024-03-31T02:10:00", "2024-10-27T02:10:00", "2024-10-27T02:20:00",
+                              "2024-10-27T03:00:00", "9999-12-31T23:59:59"):
+                with self.subTest(timestamp=timestamp):
+                    self.assertLocalized(timestamp, "Test_Slim")
+                    self.assertLocalized(timestamp, "Test_Slim", 1, ambiguous="later", nonexistent="shift_backward")
+
+            self.assertRaisesRegex(ValueError, r"Invalid TZif data for time zone Test_Invalid", parse_datetime, "2024-01-01", assume_tz="Test_Invalid")
+
+    def test_invalid_arguments(self):
+        for key in ("../etc/passwd", "/etc/localtime", "America//New_York", "America/./New_York", "", "America/New York"):
+            self.assertRaisesRegex(ValueError, r"Invalid time zone key", parse_datetime, "2024-01-01", assume_tz=key)
+        self.assertRaisesRegex(ValueError, r"No time zone found with key Nowhere/Special", parse_datetime, "2024-01-01", assume_tz="Nowhere/Special")
+        self.assertRaisesRegex(TypeError, r"assume_tz must be a str", parse_datetime, "2024-01-01", assume_tz=1)
+        self.assertRaisesRegex(ValueError, r"ambiguous must be", parse_datetime, "2024-01-01", assume_tz="UTC", ambiguous="fold")
+        self.assertRaisesRegex(ValueError, r"nonexistent must be", parse_epoch_many, [], array.array("q"), assume_tz="UTC", nonexistent="fold")
+        self.assertRaisesRegex(TypeError, r"takes exactly 1 positional argument", parse_datetime, "2024-01-01", "UTC")
+        self.assertRaisesRegex(TypeError, r"unexpected keyword argument 'tz'", parse_datetime, "2024-01-01", tz="UTC")
+        self.assertRaisesRegex(ValueError, r"Invalid character while parsing year", parse_datetime, "junk", assume_tz="UTC")
+
+
+class DedupeTestCase(unittest.TestCase):
+    TIMESTAMPS = ["2014-02-03T10:35:27Z", "2014-02-03", "junk", "2014-02-03T10:35:27Z", "2014-11-02T01:30:00", "junk", "2014-02-03", "2014-02-03T10:35:27Z"]
+
+    def test_parse_bucket_many(self):
+        for as_datetime in (False, True):
+            result, unique = parse_bucket_many(self.TIMESTAMPS[:2] * 3, "hour", as_datetime, dedupe=True)
+            self.assertEqual(result, parse_bucket_many(self.TIMESTAMPS[:2] * 3, "hour", as_datetime))
+            self.assertEqual(unique, 2)
+            # The rows with the same string share the same result
+            self.assertIs(result[4], result[0])
+        self.assertEqual(parse_bucket_many([], "hour", dedupe=True), ([], 0))
+        self.assertRaisesRegex(ValueError, r"Invalid character", parse_bucket_many, self.TIMESTAMPS, "hour", dedupe=True)
+        self.assertRaisesRegex(TypeError, r"argument must be str", parse_bucket_many, ["2014-02-03", b"2014-02-03"], "hour", dedupe=True)
+
+    def test_out(self):
+        expected, out = array.array("q", [0] * 9), array.array("q", [0] * 9)
+        self.assertEqual(parse_bucket_many(self.TIMESTAMPS, 900, out=expected, offset=1), (6, [2, 5]))
+        self.assertEqual(parse_bucket_many(self.TIMESTAMPS, 900, out=out, offset=1, dedupe=True), (6, [2, 5], 4))
+        self.assertEqual(out, expected)
+
+        self.assertEqual(parse_epoch_many(self.TIMESTAMPS, expected, 1), (6, [2, 5]))
+        self.assertEqual(parse_epoch_many(self.TIMESTAMPS, out, 1, dedupe=True), (6, [2, 5], 4))
+        self.assertEqual(out, expected)
+        self.assertEqual(parse_epoch_many([], out, dedupe=True), (0, [], 0))
+
+    def test_assume_tz(self):
+        expected, out = array.array("q", [0] * 8), array.array("q", [0] * 8)
+        try:
+            self.assertEqual(parse_epoch_many(self.TIMESTAMPS, expected, assume_tz="America/New_York", ambiguous="raise"), (5, [2, 4, 5]))
+        except ValueError:
+            self.skipTest("The time zone database doesn't have America/New_York")
+        self.assertEqual(parse_epoch_many(self.TIMESTAMPS, out, assume_tz="America/New_York", ambiguous="raise", dedupe=True), (5, [2, 4, 5], 4))
+        self.assertEqual(out, expected)
+
+    def test_parse_delimited_column(self):
+        data = "".join("{0},{1}\r\n".format(i, timestamp) for i, timestamp in enumerate(self.TIMESTAMPS[:2] * 3)).encode("utf-8")
+        result, unique = parse_delimited_column(data, 1, dedupe=True)
+        self.assertEqual(result, parse_delimited_column(data, 1))
+        self.assertEqual(unique, 2)
+        self.assertIs(result[2], result[0])
+
+        data = "".join("{0},{1}\n".format(i, timestamp) for i, timestamp in enumerate(self.TIMESTAMPS)).encode("utf-8") + b"8\n"
+        expected, out = array.array("q", [0] * 9), array.array("q", [0] * 9)
+        self.assertEqual(parse_delimited_column(data, 1, out=expected), (6, [2, 5, 8]))
+        self.assertEqual(parse_delimited_column(data, 1, out=out, dedupe=True), (6, [2, 5, 8], 4))
+        self.assertEqual(out, expected)
+        self.assertRaisesRegex(ValueError, r"Record 2: Invalid character", parse_delimited_column, data, 1, dedupe=True)
+
+
+class DurationTestCase(unittest.TestCase):
+    def test_valid_durations(self):
+        for duration, expected in [
+            ("P1D", datetime.timedelta(days=1)),
+            ("P1DT12H", datetime.timedelta(days=1, hours=12)),
+            ("PT36H", datetime.timedelta(hours=36)),
+            ("P2W", datetime.timedelta(weeks=2)),
+            ("P2W3DT4H5M6S", datetime.timedelta(weeks=2, days=3, hours=4, minutes=5, seconds=6)),
+            ("PT0S", datetime.timedelta(0)),
+            ("P0Y0M1D", datetime.timedelta(days=1)),
+            ("PT1.5H", datetime.timedelta(hours=1, minutes=30)),
+            ("P0.5D", datetime.timedelta(hours=12)),
+            ("PT1,25M", datetime.timedelta(minutes=1, seconds=15)),
+            ("PT0.000001S", datetime.timedelta(microseconds=1)),
+            ("PT1.1234567S", datetime.timedelta(seconds=1, microseconds=123456)),
+            ("-P1DT1H", -datetime.timedelta(days=1, hours=1)),
+            ("+PT1M", datetime.timedelta(minutes=1)),
+            ("P999999999D", datetime.timedelta(days=999999999)),
+        ]:
+            self.assertEqual(parse_duration(duration), expected, duration)
+
+    def test_calendar_components(self):
+        for duration in ("P1Y", "P1M", "P1Y2M3D", "P0.5Y"):
+            self.assertRaisesRegex(ValueError, r"approximate=True", parse_duration, duration)
+        self.assertEqual(parse_duration("P1Y", approximate=True), datetime.timedelta(days=365.2425))
+        self.assertEqual(parse_duration("P1M", approximate=True), datetime.timedelta(days=365.2425 / 12))
+        self.assertEqual(parse_duration("P1Y1D", approximate=True), datetime.timedelta(days=366.2425))
+        self.assertEqual(parse_duration("PT1M"), datetime.timedelta(minutes=1))
+
+    def test_invalid_durations(self):
+        for duration, message in [
+            ("", r"Unexpected end of string while parsing duration designator \('P'\)"),
+            ("1D", r"Invalid character while parsing duration designator \('P'\) \('1', Index: 0\)"),
+            ("P", r"Duration must have at least one component"),
+            ("PT", r"Unexpected end of string while parsing duration component"),
+            ("P1DT", r"Unexpected end of string while parsing duration component"),
+            ("P1", r"Unexpected end of string while parsing duration component designator"),
+            ("P1X", r"Invalid character while parsing duration component designator \('X', Index: 2\)"),
+            ("P1H", r"Invalid character while parsing duration component designator \('H', Index: 2\)"),
+            ("PT1D", r"Invalid character while parsing duration component designator \('D', Index: 3\)"),
+            ("P1D1Y", r"Duration components must be given once each"),
+            ("PT1M1M", r"Duration components must be given once each"),
+            ("P1DTT1H", r"Duration components must be given once each"),
+            ("P1.5DT1H", r"Only the last component of a duration can have a fraction"),
+            ("P.5D", r"Invalid character while parsing duration component \('.', Index: 1\)"),
+            ("P1.D", r"Invalid character while parsing duration fraction \('D', Index: 3\)"),
+            ("P1000000000D", r"Duration component is too large"),
+        ]:
+            self.assertRaisesRegex(ValueError, message, parse_duration, duration)
+        self.assertRaises(OverflowError, parse_duration, "P999999999W")
+        self.assertRaises(TypeError, parse_duration, b"P1D")
+
+
+class IntervalTestCase(unittest.TestCase):
+    def test_start_and_end(self):
+        self.assertEqual(
+            parse_interval("2007-03-01T13:00:00Z/2008-05-11T15:30:00+01:00"),
+            (parse_datetime("2007-03-01T13:00:00Z"), parse_datetime("2008-05-11T15:30:00+01:00")),
+        )
+        self.assertEqual(parse_interval("2007-03-01/2007-03-02T24:00"), (datetime.datetime(2007, 3, 1), datetime.datetime(2007, 3, 3)))
+
+    def test_durations(self):
+        start = parse_datetime("2007-03-01T13:00:00Z")
+        end = parse_datetime("2008-05-11T15:30:00Z")
+        self.assertEqual(parse_interval("2007-03-01T13:00:00Z/P1Y2M10DT2H30M"), (start, end))
+        self.assertEqual(parse_interval("P1Y2M10DT2H30M/2008-05-11T15:30:00Z"), (start, end))
+        self.assertEqual(parse_interval("2007-03-01T13:00:00Z/PT1.5H"), (start, start + datetime.timedelta(hours=1.5)))
+
+    def test_months_are_clamped_to_the_end_of_the_month(self):
+        self.assertEqual(parse_interval("2020-01-31/P1M"), (datetime.datetime(2020, 1, 31), datetime.datetime(2020, 2, 29)))
+        self.assertEqual(parse_interval("2021-01-31/P1M"), (datetime.datetime(2021, 1, 31), datetime.datetime(2021, 2, 28)))
+        self.assertEqual(parse_interval("P1M/2020-03-31"), (datetime.datetime(2020, 2, 29), datetime.datetime(2020, 3, 31)))
+        self.assertEqual(parse_interval("2020-02-29/P1Y"), (datetime.datetime(2020, 2, 29), datetime.datetime(2021, 2, 28)))
+
+    def test_invalid_intervals(self):
+        self.assertRaisesRegex(ValueError, r"Interval must be two parts separated by '/'", parse_interval, "2020-01-01")
+        self.assertRaisesRegex(ValueError, r"Interval can't be made of two durations", parse_interval, "P1D/P1D")
+        self.assertRaisesRegex(ValueError, r"Fractional years and months are not supported in intervals", parse_interval, "2020-01-01/P1.5M")
+        self.assertRaisesRegex(ValueError, r"month must be in 1..12", parse_interval, "2020-01-01/2020-13-01")
+        # Indices are relative to the whole interval
+        self.assertRaisesRegex(ValueError, r"Invalid character while parsing day \('x', Index: 20\)", parse_interval, "2020-01-01/2020-01-0x")
+        self.assertRaisesRegex(ValueError, r"Invalid character while parsing duration component \('X', Index: 12\)", parse_interval, "2020-01-01/PX")
+        self.assertRaisesRegex(ValueError, r"Unexpected end of string while parsing year", parse_interval, "/2020-01-01")
+        self.assertRaisesRegex(OverflowError, r"date value out of range", parse_interval, "9999-12-01/P1M")
+        self.assertRaisesRegex(OverflowError, r"date value out of range", parse_interval, "P1D/0001-01-01")
+
+
+class CisoFields(ctypes.Structure):
+    _fields_ = [(name, ctypes.c_int) for name in ("year", "month", "day", "hour", "minute", "second", "usecond", "has_tzinfo", "tzminute")]
+
+
+class CisoCAPI(ctypes.Structure):
+    _fields_ = [
+        ("version", ctypes.c_int),
+        ("parse_datetime", ctypes.PYFUNCTYPE(ctypes.py_object, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int)),
+        ("parse_epoch", ctypes.PYFUNCTYPE(ctypes.c_int, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int, ctypes.POINTER(ctypes.c_int64))),
+        ("parse_fields", ctypes.PYFUNCTYPE(ctypes.c_int, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int, ctypes.POINTER(CisoFields))),
+    ]
+
+
+@unittest.skipUnless(platform.python_implementation() == 'CPython', "Uses ctypes.pythonapi to read the capsule")
+class CAPITestCase(unittest.TestCase):
+    RFC3339 = 0x1
+    NAIVE = 0x2
+    RFC2822 = 0x4
+    HTTP_DATE = 0x8
+
+    @classmethod
+    def setUpClass(cls):
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+        cls.api = CisoCAPI.from_address(get_pointer(_C_API, b"ciso8601._C_API"))
+
+    def test_version(self):
+        self.assertGreaterEqual(self.api.version, 2)
+
+    def test_parse_datetime(self):
+        for (timestamp, expected_datetime) in generate_valid_timestamp_and_datetime():
+            buf = timestamp.encode("ascii")
+            self.assertEqual(self.api.parse_datetime(buf, len(buf), 0), expected_datetime)
+            self.assertEqual(self.api.parse_datetime(buf, len(buf), self.NAIVE), expected_datetime.replace(tzinfo=None))
+
+        # Only `len` bytes are parsed
+        self.assertEqual(self.api.parse_datetime(b"2014-02-03T10:35:27 trailing", 19, 0), datetime.datetime(2014, 2, 3, 10, 35, 27))
+        self.assertRaisesRegex(ValueError, r"RFC 3339", self.api.parse_datetime, b"2014-02-03", 10, self.RFC3339)
+
+    def test_rfc2822_and_http_date(self):
+        result = ctypes.c_int64()
+        buf = b"Mon, 03 Feb 2014 10:35:27 +0530"
+        self.assertEqual(self.api.parse_datetime(buf, len(buf), self.RFC2822), parse_rfc2822(buf.decode()))
+        self.assertEqual(self.api.parse_datetime(buf, len(buf), self.RFC2822 | self.NAIVE), datetime.datetime(2014, 2, 3, 10, 35, 27))
+        self.assertRaisesRegex(ValueError, r"HTTP dates must be in GMT", self.api.parse_datetime, buf, len(buf), self.HTTP_DATE)
+
+        buf = b"Mon, 03 Feb 2014 10:35:27 GMT"
+        self.assertEqual(self.api.parse_epoch(buf, len(buf), self.HTTP_DATE, ctypes.byref(result)), 0)
+        self.assertEqual(result.value, 1391423727000000)
+        fields = CisoFields()
+        self.assertEqual(self.api.parse_fields(buf, len(buf), self.RFC2822, ctypes.byref(fields)), 0)
+        self.assertEqual(
+            [getattr(fields, name) for name, _ in CisoFields._fields_],
+            [2014, 2, 3, 10, 35, 27, 0, 1, 0],
+        )
+
+    def test_parse_epoch(self):
+        epoch = datetime.datetime(1970, 1, 1, tzinfo=datetime.timezone.utc)
+        result = ctypes.c_int64()
+        for (timestamp, expected_datetime) in generate_valid_timestamp_and_datetime():
+            buf = timestamp.encode("ascii")
+            self.assertEqual(self.api.parse_epoch(buf, len(buf), 0, ctypes.byref(result)), 0)
+            if expected_datetime.tzinfo is None:
+                expected_datetime = expected_datetime.replace(tzinfo=datetime.timezone.utc)
+            self.assertEqual(result.value, (expected_datetime - epoch) // datetime.timedelta(microseconds=1))
+
+        self.assertEqual(self.api.parse_epoch(b"2014-02-03T24:00:00", 19, 0, ctypes.byref(result)), 0)
+        self.assertEqual(result.value, 1391472000000000)
+        self.assertRaisesRegex(ValueError, r"day is out of range for month", self.api.parse_epoch, b"2014-02-30", 10, 0, ctypes.byref(result))
+
+    def test_parse_fields(self):
+        fields = CisoFields()
+        self.assertEqual(self.api.parse_fields(b"2014-02-03T10:35:27.123-05:30", 29, 0, ctypes.byref(fields)), 0)
+        self.assertEqual(
+            [getattr(fields, name) for name, _ in CisoFields._fields_],
+            [2014, 2, 3, 10, 35, 27, 123000, 1, -330],
+        )
+        self.assertEqual(self.api.parse_fields(b"2014-12-31T24:00:00Z", 20, self.NAIVE, ctypes.byref(fields)), 0)
+        self.assertEqual(
+            [getattr(fields, name) for name, _ in CisoFields._fields_],
+            [2015, 1, 1, 0, 0, 0, 0, 0, 0],
+        )
+        self.assertRaisesRegex(OverflowError, r"date value out of range", self.api.parse_fields, b"9999-12-31T24:00:00", 19, 0, ctypes.byref(fields))
+
+
+@unittest.skipIf(stats() is None, "ciso8601 was built without CISO8601_STATS_ENABLED=1")
+class StatsTestCase(unittest.TestCase):
+    def setUp(self):
+        reset_stats()
+
+    def parse_ignoring_errors(self, *timestamps):
+        for timestamp in timestamps:
+            try:
+                parse_datetime(timestamp)
+            except ValueError:
+                pass
+
+    def test_format_families(self):
+        self.parse_ignoring_errors("20140203", "2014-02-03", "2014-02", "2014034", "2014-034", "2014W06", "2014-W06-1")
+        counts = stats()
+        self.assertEqual(counts["parses"], 7)
+        self.assertEqual(
+            counts["formats"],
+            {
+                "calendar_basic": 1,
+                "calendar_extended": 2,
+                "ordinal_basic": 1,
+                "ordinal_extended": 1,
+                "week_basic": 1,
+                "week_extended": 1,
+            },
+        )
+
+    def test_fraction_digits(self):
+        self.parse_ignoring_errors("2014-02-03T01:23:45.1", "2014-02-03T01:23:45.123456", "2014-02-03T01:23:45,123456", "2014-02-03T01:23:45.123456789", "2014-02-03T01:23:45." + "1" * 20)
+        self.assertEqual(stats()["fraction_digits"], {1: 1, 6: 2, 9: 1, 15: 1})
+
+    def test_midnight_rollovers(self):
+        self.parse_ignoring_errors("2014-02-03T24:00", "2014-02-03T00:00")
+        self.assertEqual(stats()["midnight_rollovers"], 1)
+
+    def test_errors_by_field(self):
+        self.parse_ignoring_errors("2014-02-0", "2014-02-0a", "2014-13-01", "2014-02-03T25", "2014-02-03T01:23:45Zjunk", "2014-366", "2014-W54", "20140203T01:23", "2014-02-03T01:23:45+05:60", "2014-02-03X01")
+        try:
+            parse_rfc3339("2014-02-03")
+        except ValueError:
+            pass
+        self.assertEqual(
+            stats()["errors"],
+            {
+                "day": 2,
+                "month": 1,
+                "hour": 1,
+                "trailing characters": 1,
+                "ordinal day": 1,
+                "iso calendar date": 1,
+                "mixed basic and extended formats": 1,
+                "tz minute": 1,
+                "separator": 1,
+                "rfc3339": 1,
+            },
+        )
+
+    def test_rfc2822_errors(self):
+        for parse, string in [
+            (parse_http_date, "Sun, 06 Nov 1994 08:49:37 UTC"),
+            (parse_rfc2822, "Sux, 06 Nov 1994 08:49:37 GMT"),
+            (parse_rfc2822, "Sun, 06 Nov 1994 08:49:37 ABCDEF"),
+            (parse_rfc2822, "Sun 06 Nov 1994 08:49:37 GMT"),
+            (parse_rfc2822, "Sun, 06 Nox 1994 08:49:37 GMT"),
+        ]:
+            self.assertRaises(ValueError, parse, string)
+        self.assertEqual(stats()["errors"], {"http date zone": 1, "day of week": 1, "time zone": 1, "separator": 1, "month": 1})
+
+    def test_tz_cache(self):
+        self.parse_ignoring_errors("2014-02-03T01:23:45+05:17", "2014-02-03T01:23:45+05:17", "2014-02-03T01:23:45Z")
+        tz_cache = stats()["tz_cache"]
+        if tz_cache is None:  # i.e., CISO8601_CACHING_ENABLED=0
+            return
+        self.assertEqual(tz_cache["hits"] + tz_cache["misses"], 2)
+        self.assertGreaterEqual(tz_cache["hits"], 1)
+        self.assertGreaterEqual(tz_cache["entries"], 1)
+
+    def test_reset_stats(self):
+        self.parse_ignoring_errors("2014-02-03", "2014-02-0")
+        reset_stats()
+        counts = stats()
+        self.assertEqual(counts["parses"], 0)
+        self.assertEqual(counts["errors"], {})
+        self.assertEqual(set(counts["formats"].values()), {0})
+
+
 class FixedOffsetTestCase(unittest.TestCase):
     def test_all_valid_offsets(self):
         [FixedOffset(i * 60) for i in range(-1439, 1440)]
@@ -560,6 +1581,32 @@ class PicklingTestCase(unittest.TestCase):
         dt3 = copy.deepcopy(dt)
         self.assertEqual(dt, dt3)
 
+    def test_unpickling_reuses_cached_fixed_offsets(self):
+        dts = [parse_datetime('2018-11-01 20:42:09+05:30'), parse_datetime('2018-11-02 20:42:09+05:30')]
+        unpickled = [pickle.loads(pickle.dumps(dt)) for dt in dts]
+        self.assertEqual(unpickled, dts)
+        if dts[0].tzinfo is dts[1].tzinfo:  # i.e., built with CISO8601_CACHING_ENABLED=1
+            self.assertIs(unpickled[0].tzinfo, dts[0].tzinfo)
+            self.assertIs(unpickled[1].tzinfo, dts[0].tzinfo)
+
+    def test_pickle_fixed_offsets(self):
+        for offset in (0, 45, 3600, -19800, 86399):
+            for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+                tzinfo = pickle.loads(pickle.dumps(FixedOffset(offset), protocol=protocol))
+                self.assertIsInstance(tzinfo, FixedOffset)
+                self.assertEqual(tzinfo.offset, offset)
+
+    def test_pickle_fixed_offset_subclass(self):
+        tzinfo = FixedOffsetSubclass(3600)
+        tzinfo.name = "Europe/Paris"
+        unpickled = pickle.loads(pickle.dumps(tzinfo))
+        self.assertIsInstance(unpickled, FixedOffsetSubclass)
+        self.assertEqual((unpickled.offset, unpickled.name), (3600, "Europe/Paris"))
+
+
+class FixedOffsetSubclass(FixedOffset):
+    pass
+
 
 class GithubIssueRegressionTestCase(unittest.TestCase):
     # These are test cases that were provided in GitHub issues submitted to ciso8601.
@@ -47,6 +47,8 @@ typedef struct {
     PyObject_HEAD int offset;
 } FixedOffset;
 
+static PyTypeObject FixedOffset_type;
+
 static int
 FixedOffset_init(FixedOffset *self, PyObject *args, PyObject *kwargs)
 {
@@ -134,8 +136,27 @@ FixedOffset_repr(FixedOffset *self)
 static PyObject *
 FixedOffset_getinitargs(FixedOffset *self)
 {
-    PyObject *args = PyTuple_Pack(1, PyLong_FromLong(self->offset));
-    return args;
+    return Py_BuildValue("(i)", self->offset);
+}
+
+/* `ciso8601._fixed_offset`, which is looked up in `initialize_timezone_code`
+ */
+static PyObject *fixed_offset_constructor = NULL;
+
+static PyObject *
+FixedOffset_reduce(FixedOffset *self, PyObject *ignored)
+{
+    /* Subclasses keep tzinfo's default pickling, which also saves their
+     * __dict__
+     */
+    if (Py_TYPE(self) != &FixedOffset_type)
+        return PyObject_CallMethod((PyObject *)PyDateTimeAPI->TZInfoType,
+                                   "__reduce__", "O", self);
+
+    /* Unpickled through `_fixed_offset`, so that it reuses the cached
+     * instance rather than creating a new one for every datetime
+     */
+    return Py_BuildValue("O(i)", fixed_offset_constructor, self->offset);
 }
 
 /*
@@ -162,6 +183,9 @@ static PyMethodDef FixedOffset_methods[] = {
     {"__getinitargs__", (PyCFunction)FixedOffset_getinitargs, METH_NOARGS,
      PyDoc_STR("pickle support")},
 
+    {"__reduce__", (PyCFunction)FixedOffset_reduce, METH_NOARGS,
+     PyDoc_STR("pickle support")},
+
     {NULL}};
 
 static PyTypeObject FixedOffset_type = {
@@ -227,6 +251,10 @@ initialize_timezone_code(PyObject *module)
     if (PyType_Ready(&FixedOffset_type) < 0)
         return -1;
 
+    fixed_offset_constructor = PyObject_GetAttrString(module, "_fixed_offset");
+    if (fixed_offset_constructor == NULL)
+        return -1;
+
     Py_INCREF(&FixedOffset_type);
     if (PyModule_AddObject(module, "FixedOffset",
                            (PyObject *)&FixedOffset_type) < 0) {
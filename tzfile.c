@@ -0,0 +1,447 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "isocalendar.h"
+#include "tzfile.h"
+
+/* `ymd_to_ord(1970, 1, 1)` */
+#define EPOCH_ORDINAL   719163
+#define SECONDS_PER_DAY 86400
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/* Length of the header of each data block of a TZif file */
+#define TZIF_HEADER_LENGTH 44
+
+/* Transitions far outside of the range of datetimes (such as the "big bang"
+ * transition at -2**59 that some files start with) are still accepted, as
+ * long as local times can be computed from them without overflowing.
+ */
+#define MAX_TRANSITION_TIME ((int64_t)1 << 62)
+
+static uint32_t
+_read_be32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static int64_t
+_read_be64(const unsigned char *p)
+{
+    return (int64_t)(((uint64_t)_read_be32(p) << 32) | _read_be32(p + 4));
+}
+
+/* The counts of a TZif header, in the order they appear in */
+typedef struct {
+    uint32_t isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt;
+} TZifCounts;
+
+/* Reads the header at `p` and returns the length of the data block that
+ * follows it, for times of `time_size` bytes
+ */
+static uint64_t
+_read_header(const unsigned char *p, TZifCounts *counts, int time_size)
+{
+    counts->isutcnt = _read_be32(p + 20);
+    counts->isstdcnt = _read_be32(p + 24);
+    counts->leapcnt = _read_be32(p + 28);
+    counts->timecnt = _read_be32(p + 32);
+    counts->typecnt = _read_be32(p + 36);
+    counts->charcnt = _read_be32(p + 40);
+
+    return (uint64_t)counts->timecnt * (time_size + 1) +
+           (uint64_t)counts->typecnt * 6 + counts->charcnt +
+           (uint64_t)counts->leapcnt * (time_size + 4) + counts->isstdcnt +
+           counts->isutcnt;
+}
+
+/* POSIX TZ strings (e.g., `EST5EDT,M3.2.0,M11.1.0`) */
+
+/* Parses a zone abbreviation, either alphabetic (`EST`) or quoted (`<-03>`)
+ */
+static const char *
+_parse_tz_name(const char *c, const char *end)
+{
+    const char *start = c;
+
+    if (c < end && *c == '<') {
+        while (++c < end && *c != '>')
+            if (!((*c >= 'A' && *c <= 'Z') || (*c >= 'a' && *c <= 'z') ||
+                  (*c >= '0' && *c <= '9') || *c == '+' || *c == '-'))
+                return NULL;
+        return c < end && c - start > 1 ? c + 1 : NULL;
+    }
+    while (c < end && ((*c >= 'A' && *c <= 'Z') || (*c >= 'a' && *c <= 'z')))
+        c++;
+    return c - start >= 3 ? c : NULL;
+}
+
+/* Parses `[+-]hh[:mm[:ss]]` into seconds. `max_hours` is 24 for offsets and
+ * 167 for the times of rules (as allowed by RFC 8536).
+ */
+static const char *
+_parse_tz_time(const char *c, const char *end, int max_hours,
+               int32_t *seconds)
+{
+    int sign = 1, value, digits, part;
+
+    if (c < end && (*c == '+' || *c == '-'))
+        sign = *c++ == '-' ? -1 : 1;
+
+    *seconds = 0;
+    for (part = 0; part < 3; part++) {
+        if (part > 0) {
+            if (c >= end || *c != ':')
+                break;
+            c++;
+        }
+        for (value = 0, digits = 0;
+             c < end && *c >= '0' && *c <= '9' && digits < 3; c++, digits++)
+            value = value * 10 + (*c - '0');
+        if (digits == 0 || (part > 0 && (digits != 2 || value > 59)) ||
+            (part == 0 && value > max_hours))
+            return NULL;
+        *seconds += value * (part == 0 ? 3600 : part == 1 ? 60 : 1);
+    }
+    *seconds *= sign;
+    return c;
+}
+
+static const char *
+_parse_tz_number(const char *c, const char *end, int min, int max,
+                 int *value)
+{
+    const char *start = c;
+
+    for (*value = 0; c < end && *c >= '0' && *c <= '9' && c - start < 3; c++)
+        *value = *value * 10 + (*c - '0');
+    return c > start && *value >= min && *value <= max ? c : NULL;
+}
+
+/* Parses `Jn`, `n` or `Mm.w.d`, followed by an optional `/time` */
+static const char *
+_parse_tz_rule_date(const char *c, const char *end,
+                    ciso8601_tzrule_date *date)
+{
+    if (c < end && *c == 'J') {
+        date->kind = 'J';
+        c = _parse_tz_number(c + 1, end, 1, 365, &date->day);
+    }
+    else if (c < end && *c == 'M') {
+        date->kind = 'M';
+        if ((c = _parse_tz_number(c + 1, end, 1, 12, &date->month)) == NULL ||
+            c >= end || *c++ != '.' ||
+            (c = _parse_tz_number(c, end, 1, 5, &date->week)) == NULL ||
+            c >= end || *c++ != '.')
+            return NULL;
+        c = _parse_tz_number(c, end, 0, 6, &date->weekday);
+    }
+    else {
+        date->kind = 'D';
+        c = _parse_tz_number(c, end, 0, 365, &date->day);
+    }
+    if (c == NULL)
+        return NULL;
+
+    date->time = 2 * 3600;
+    if (c < end && *c == '/')
+        c = _parse_tz_time(c + 1, end, 167, &date->time);
+    return c;
+}
+
+static int
+_parse_tz_string(const char *c, const char *end, ciso8601_tzrule *rule)
+{
+    int32_t offset;
+
+    memset(rule, 0, sizeof(*rule));
+    if ((c = _parse_tz_name(c, end)) == NULL ||
+        (c = _parse_tz_time(c, end, 24, &offset)) == NULL)
+        return -1;
+    /* POSIX offsets are positive west of UTC */
+    rule->std_offset = rule->dst_offset = -offset;
+    if (c == end)
+        return 0;
+
+    if ((c = _parse_tz_name(c, end)) == NULL)
+        return -1;
+    rule->has_dst = 1;
+    rule->dst_offset = rule->std_offset + 3600;
+    if (c < end && *c != ',') {
+        if ((c = _parse_tz_time(c, end, 24, &offset)) == NULL)
+            return -1;
+        rule->dst_offset = -offset;
+    }
+
+    /* The rules are optional in POSIX, but TZif files always have them */
+    if (c >= end || *c++ != ',' ||
+        (c = _parse_tz_rule_date(c, end, &rule->start)) == NULL ||
+        c >= end || *c++ != ',' ||
+        (c = _parse_tz_rule_date(c, end, &rule->end)) == NULL)
+        return -1;
+    return c == end ? 0 : -1;
+}
+
+/* Local time (in seconds since 1970-01-01T00:00:00, local time) at which the
+ * rule switches in `year`
+ */
+static int64_t
+_rule_date_local_time(const ciso8601_tzrule_date *date, int year)
+{
+    int ordinal = ymd_to_ord(year, 1, 1), first;
+
+    switch (date->kind) {
+        case 'J':
+            ordinal += date->day - 1;
+            if (date->day >= 60 && days_in_month(year, 2) == 29)
+                ordinal++;
+            break;
+        case 'D':
+            ordinal += date->day;
+            break;
+        default:
+            first = ymd_to_ord(year, date->month, 1);
+            /* `ordinal % 7` is 0 on Sundays, as the weekdays of rules are */
+            ordinal = first + (date->weekday - first % 7 + 7) % 7 +
+                      7 * (date->week - 1);
+            while (ordinal - first >= days_in_month(year, date->month))
+                ordinal -= 7;
+            break;
+    }
+    return (int64_t)(ordinal - EPOCH_ORDINAL) * SECONDS_PER_DAY + date->time;
+}
+
+/* Binary searches `transitions` for the last one that `local` is at or after
+ * the start of (i.e., at or after the earlier of the local times at which
+ * it happened).
+ */
+static ciso8601_local_time
+_find_offsets(const ciso8601_transition *transitions, size_t count,
+              int32_t initial, int64_t local, int32_t *before, int32_t *after)
+{
+    const ciso8601_transition *transition;
+    size_t lo = 0, hi = count, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        transition = &transitions[mid];
+        if (transition->utc + MIN(transition->before, transition->after) <=
+            local)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0) {
+        *before = *after = initial;
+        return CISO8601_LOCAL_UNIQUE;
+    }
+
+    transition = &transitions[lo - 1];
+    if (local < transition->utc + MAX(transition->before, transition->after)) {
+        *before = transition->before;
+        *after = transition->after;
+        return transition->after > transition->before
+                   ? CISO8601_LOCAL_NONEXISTENT
+                   : CISO8601_LOCAL_AMBIGUOUS;
+    }
+    *before = *after = transition->after;
+    return CISO8601_LOCAL_UNIQUE;
+}
+
+/* Like `_find_offsets`, with the transitions of the rule in the years around
+ * `local`
+ */
+static ciso8601_local_time
+_rule_offsets(const ciso8601_tzrule *rule, int64_t local, int32_t *before,
+              int32_t *after)
+{
+    ciso8601_transition transitions[6], transition;
+    int year, month, day, y;
+    size_t count = 0, i, j;
+    int64_t days;
+
+    if (!rule->has_dst) {
+        *before = *after = rule->std_offset;
+        return CISO8601_LOCAL_UNIQUE;
+    }
+
+    days = local / SECONDS_PER_DAY - (local % SECONDS_PER_DAY < 0);
+    days = MIN(MAX(days + EPOCH_ORDINAL, 1), ymd_to_ord(9999, 12, 31));
+    ord_to_ymd((int)days, &year, &month, &day);
+
+    for (y = year - 1; y <= year + 1; y++) {
+        /* The start is in standard time, and the end in daylight time */
+        transition.utc =
+            _rule_date_local_time(&rule->start, y) - rule->std_offset;
+        transition.before = rule->std_offset;
+        transition.after = rule->dst_offset;
+        transitions[count++] = transition;
+
+        transition.utc =
+            _rule_date_local_time(&rule->end, y) - rule->dst_offset;
+        transition.before = rule->dst_offset;
+        transition.after = rule->std_offset;
+        transitions[count++] = transition;
+    }
+
+    /* Insertion sort, which is stable, as a switch to and from DST at the
+     * same time must stay in that order
+     */
+    for (i = 1; i < count; i++) {
+        transition = transitions[i];
+        for (j = i; j > 0 && transitions[j - 1].utc > transition.utc; j--)
+            transitions[j] = transitions[j - 1];
+        transitions[j] = transition;
+    }
+
+    /* Rules that are in DST all year (e.g., `J1/0,J365/25`) end DST at the
+     * same time as they start it again, which isn't a transition at all
+     */
+    for (i = 0, j = 0; i < count; i++) {
+        if (j > 0 && transitions[j - 1].utc == transitions[i].utc) {
+            transitions[j - 1].after = transitions[i].after;
+            if (transitions[j - 1].before == transitions[j - 1].after)
+                j--;
+            continue;
+        }
+        transitions[j++] = transitions[i];
+    }
+
+    if (j == 0) {
+        *before = *after = rule->dst_offset;
+        return CISO8601_LOCAL_UNIQUE;
+    }
+    return _find_offsets(transitions, j, transitions[0].before, local, before,
+                         after);
+}
+
+ciso8601_zone_error
+ciso8601_zone_load(const unsigned char *data, size_t len, ciso8601_zone *zone)
+{
+    const unsigned char *p = data, *end = data + len, *times, *indices;
+    const unsigned char *footer, *footer_end;
+    TZifCounts counts;
+    uint64_t block_length;
+    int time_size = 4;
+    int32_t *offsets = NULL;
+    int32_t offset, previous;
+    int64_t utc, previous_utc = INT64_MIN;
+    uint32_t i;
+
+    memset(zone, 0, sizeof(*zone));
+
+    if (len < TZIF_HEADER_LENGTH || memcmp(data, "TZif", 4) != 0)
+        return CISO8601_ZONE_INVALID;
+    block_length = _read_header(p, &counts, 4);
+
+    /* Version 2 and up repeat the data with 64-bit times (which is the only
+     * part that needs to be read), followed by the TZ string footer
+     */
+    if (data[4] >= '2') {
+        if (block_length > (uint64_t)(end - p) - TZIF_HEADER_LENGTH)
+            return CISO8601_ZONE_INVALID;
+        p += TZIF_HEADER_LENGTH + block_length;
+        if (end - p < TZIF_HEADER_LENGTH || memcmp(p, "TZif", 4) != 0)
+            return CISO8601_ZONE_INVALID;
+        time_size = 8;
+        block_length = _read_header(p, &counts, 8);
+    }
+    if (counts.typecnt == 0 ||
+        block_length > (uint64_t)(end - p) - TZIF_HEADER_LENGTH)
+        return CISO8601_ZONE_INVALID;
+    p += TZIF_HEADER_LENGTH;
+
+    times = p;
+    indices = times + (size_t)counts.timecnt * time_size;
+    offsets = malloc(counts.typecnt * sizeof(int32_t));
+    if (counts.timecnt > 0)
+        zone->transitions =
+            malloc(counts.timecnt * sizeof(ciso8601_transition));
+    if (offsets == NULL ||
+        (counts.timecnt > 0 && zone->transitions == NULL)) {
+        free(offsets);
+        ciso8601_zone_free(zone);
+        return CISO8601_ZONE_NO_MEMORY;
+    }
+
+    for (i = 0; i < counts.typecnt; i++) {
+        offsets[i] = (int32_t)_read_be32(indices + counts.timecnt + 6 * i);
+        /* Python's tzinfos must be less than a day away from UTC */
+        if (offsets[i] <= -SECONDS_PER_DAY || offsets[i] >= SECONDS_PER_DAY)
+            goto invalid;
+    }
+
+    /* Transitions that only change the abbreviation or whether it is DST are
+     * left out
+     */
+    zone->initial = previous = offsets[0];
+    for (i = 0; i < counts.timecnt; i++) {
+        utc = time_size == 8 ? _read_be64(times + 8 * i)
+                             : (int32_t)_read_be32(times + 4 * i);
+        if (utc <= previous_utc || utc < -MAX_TRANSITION_TIME ||
+            utc > MAX_TRANSITION_TIME || indices[i] >= counts.typecnt)
+            goto invalid;
+        previous_utc = utc;
+
+        offset = offsets[indices[i]];
+        if (offset == previous)
+            continue;
+        zone->transitions[zone->count].utc = utc;
+        zone->transitions[zone->count].before = previous;
+        zone->transitions[zone->count].after = offset;
+        zone->count++;
+        previous = offset;
+    }
+
+    if (time_size == 8) {
+        footer = p + block_length;
+        if (footer >= end || *footer != '\n')
+            goto invalid;
+        footer_end = memchr(footer + 1, '\n', end - footer - 1);
+        if (footer_end == NULL)
+            goto invalid;
+        /* An empty footer means that there is no rule */
+        if (footer_end > footer + 1) {
+            if (_parse_tz_string((const char *)footer + 1,
+                                 (const char *)footer_end, &zone->rule) < 0)
+                goto invalid;
+            zone->has_rule = 1;
+        }
+    }
+
+    free(offsets);
+    return CISO8601_ZONE_OK;
+
+invalid:
+    free(offsets);
+    ciso8601_zone_free(zone);
+    return CISO8601_ZONE_INVALID;
+}
+
+void
+ciso8601_zone_free(ciso8601_zone *zone)
+{
+    free(zone->transitions);
+    zone->transitions = NULL;
+    zone->count = 0;
+}
+
+ciso8601_local_time
+ciso8601_zone_offsets(const ciso8601_zone *zone, int64_t local,
+                      int32_t *before, int32_t *after)
+{
+    const ciso8601_transition *last;
+
+    /* The rule takes over after the last transition */
+    if (zone->has_rule) {
+        last = zone->count > 0 ? &zone->transitions[zone->count - 1] : NULL;
+        if (last == NULL ||
+            local >= last->utc + MAX(last->before, last->after))
+            return _rule_offsets(&zone->rule, local, before, after);
+    }
+    return _find_offsets(zone->transitions, zone->count, zone->initial, local,
+                         before, after);
+}
@@ -0,0 +1,103 @@
+/* Reading IANA time zones from TZif files (RFC 8536), and resolving the UTC
+ * offsets of local times in them, independent of CPython.
+ *
+ * Unlike the parser, loading a zone allocates (the transitions are copied
+ * into a single sorted array), but resolving local times never does, and a
+ * loaded zone is never modified, so it can be shared between threads.
+ */
+#ifndef CISO8601_TZFILE_H
+#define CISO8601_TZFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A change of the UTC offset, at `utc` seconds since the epoch. Offsets are
+ * in seconds east of UTC.
+ */
+typedef struct {
+    int64_t utc;
+    int32_t before, after;
+} ciso8601_transition;
+
+/* When a rule of a POSIX TZ string (e.g., `M3.2.0/2`) switches to or from
+ * daylight saving time
+ */
+typedef struct {
+    /* 'J' (Julian day 1-365, never counting February 29), 'D' (zero-based
+     * day of the year 0-365) or 'M' (day `weekday` of week `week` of
+     * `month`, where week 5 is the last one)
+     */
+    char kind;
+    int day, month, week, weekday;
+    /* Local time of the switch, in seconds (which may be negative or more
+     * than a day)
+     */
+    int32_t time;
+} ciso8601_tzrule_date;
+
+/* The POSIX TZ string at the end of TZif files (version 2 and up), which
+ * gives the offsets after the last transition
+ */
+typedef struct {
+    int32_t std_offset, dst_offset;
+    int has_dst;
+    ciso8601_tzrule_date start, end;
+} ciso8601_tzrule;
+
+typedef struct {
+    /* Offset of the times before the first transition */
+    int32_t initial;
+    /* Only the transitions that change the offset, in order */
+    ciso8601_transition *transitions;
+    size_t count;
+    int has_rule;
+    ciso8601_tzrule rule;
+} ciso8601_zone;
+
+typedef enum {
+    CISO8601_ZONE_OK = 0,
+    CISO8601_ZONE_INVALID,
+    CISO8601_ZONE_NO_MEMORY,
+} ciso8601_zone_error;
+
+/* Loads the TZif data of `len` bytes at `data` into `zone`, which must be
+ * released with `ciso8601_zone_free`. Leap seconds are ignored, as by
+ * Python's zoneinfo. On failure, nothing needs to be released.
+ */
+ciso8601_zone_error
+ciso8601_zone_load(const unsigned char *data, size_t len,
+                   ciso8601_zone *zone);
+
+void
+ciso8601_zone_free(ciso8601_zone *zone);
+
+typedef enum {
+    CISO8601_LOCAL_UNIQUE = 0,
+    /* Repeated when the clocks were turned back (e.g., at the end of DST) */
+    CISO8601_LOCAL_AMBIGUOUS,
+    /* Skipped when the clocks were turned forward (e.g., at the start of
+     * DST)
+     */
+    CISO8601_LOCAL_NONEXISTENT,
+} ciso8601_local_time;
+
+/* Finds the UTC offset of the local time `local` (in seconds since
+ * 1970-01-01T00:00:00, local time) with a binary search of the transitions.
+ *
+ * If the local time is ambiguous or nonexistent, `*before` and `*after` are
+ * the offsets before and after the transition it is in (i.e., those that
+ * `fold=0` and `fold=1` would use). Otherwise, both are its offset.
+ */
+ciso8601_local_time
+ciso8601_zone_offsets(const ciso8601_zone *zone, int64_t local,
+                      int32_t *before, int32_t *after);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif